@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+
+#include <Document.hpp>
+#include <NdjsonParser.hpp>
+#include <ParallelReader.hpp>
+#include <StringWriteStream.hpp>
+#include <Writer.hpp>
+#include <fstream>
+#include <sstream>
+
+using namespace goa;
+
+// 把cart.json中data.data的每个成员写成一行 重复多次得到约12MB的NDJSON
+std::string makeNdjson(const char *path, size_t copies) {
+  std::ifstream in(path);
+  if (!in) exit(1);
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  json::Document doc;
+  if (doc.parse(buffer.str()) != json::ParseError::PARSE_OK) exit(1);
+
+  std::string lines;
+  for (auto &member : doc["data"]["data"].getObject()) {
+    json::StringWriteStream os;
+    json::Writer writer(os);
+    member.value.writeTo(writer);
+    lines += os.getStringView();
+    lines += '\n';
+  }
+  std::string ndjson;
+  for (size_t i = 0; i < copies; i++) ndjson += lines;
+  return ndjson;
+}
+
+const std::string &input() {
+  static std::string ndjson = makeNdjson("../../bench/taobao/cart.json", 200);
+  return ndjson;
+}
+
+// 参数为线程数
+void BM_ndjson(benchmark::State &s) {
+  const std::string &ndjson = input();
+  json::NdjsonParser parser(static_cast<size_t>(s.range(0)));
+  for (auto _ : s) {
+    std::vector<json::Document> docs;
+    auto results = parser.parse(ndjson, docs);
+    for (auto &result : results)
+      if (result != json::ParseError::PARSE_OK) exit(1);
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * ndjson.size()));
+}
+
+// 同样的记录组成一个顶层数组
+void BM_array(benchmark::State &s) {
+  static std::string array = [] {
+    std::string json = input();
+    for (auto &ch : json)
+      if (ch == '\n') ch = ',';
+    json.back() = ']';
+    return "[" + json;
+  }();
+  json::ParallelReader reader(static_cast<size_t>(s.range(0)));
+  for (auto _ : s) {
+    json::Document doc;
+    if (reader.parse(array, doc) != json::ParseError::PARSE_OK) exit(1);
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * array.size()));
+}
+
+BENCHMARK(BM_ndjson)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(BM_array)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
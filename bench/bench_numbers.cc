@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+
+#include <Document.hpp>
+#include <StringWriteStream.hpp>
+#include <Writer.hpp>
+#include <cstdio>
+#include <random>
+
+using namespace goa;
+
+// 仿照canada.json生成以浮点坐标为主的GeoJSON 固定种子保证每次输入相同
+std::string makeCanadaLike(size_t points) {
+  std::mt19937_64 rng(20240601);
+  std::uniform_real_distribution<double> lon(-141.0, -52.0);
+  std::uniform_real_distribution<double> lat(41.0, 83.0);
+  std::string json =
+      "{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\","
+      "\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[[";
+  char buf[64];
+  for (size_t i = 0; i < points; i++) {
+    if (i > 0) json += ',';
+    snprintf(buf, sizeof buf, "[%.15g,%.15g]", lon(rng), lat(rng));
+    json += buf;
+  }
+  json += "]]}}]}";
+  return json;
+}
+
+// 只含整数的数组 覆盖int32和int64两种类型
+std::string makeIntegers(size_t count) {
+  std::mt19937_64 rng(20240601);
+  std::string json = "[";
+  for (size_t i = 0; i < count; i++) {
+    if (i > 0) json += ',';
+    auto value = static_cast<int64_t>(rng());
+    json += std::to_string(i % 2 == 0 ? value >> 40 : value);
+  }
+  json += "]";
+  return json;
+}
+
+void BM_parse(benchmark::State &s, std::string json) {
+  for (auto _ : s) {
+    json::Document doc;
+    if (doc.parse(json) != json::ParseError::PARSE_OK) exit(1);
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+// 关闭NaN/Infinity和整数后缀 数字解析中不再检查这些扩展
+void BM_parse_strict(benchmark::State &s, std::string json) {
+  for (auto _ : s) {
+    json::Document doc;
+    if (doc.parse<json::kParseStrictFlags>(json) != json::ParseError::PARSE_OK)
+      exit(1);
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+void BM_parse_write(benchmark::State &s, std::string json) {
+  for (auto _ : s) {
+    json::Document doc;
+    if (doc.parse(json) != json::ParseError::PARSE_OK) exit(1);
+    json::StringWriteStream os;
+    json::Writer writer(os);
+    doc.writeTo(writer);
+    std::string_view ret = os.getStringView();
+    benchmark::DoNotOptimize(ret);
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+BENCHMARK_CAPTURE(BM_parse, canada, makeCanadaLike(56000))
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_parse, integers, makeIntegers(100000))
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_parse_strict, canada, makeCanadaLike(56000))
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_parse_strict, integers, makeIntegers(100000))
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_parse_write, canada, makeCanadaLike(56000))
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
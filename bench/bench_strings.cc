@@ -0,0 +1,98 @@
+#include <benchmark/benchmark.h>
+
+#include <Document.hpp>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+using namespace goa;
+
+constexpr unsigned kUtf8Flags =
+    json::kParseDefaultFlags | json::kParseValidateUtf8Flag;
+
+std::string readFile(const char *path) {
+  std::ifstream in(path);
+  if (!in) exit(1);
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  return buffer.str();
+}
+
+// 由字符表随机拼出的字符串组成的数组 固定种子保证每次输入相同
+std::string makeStrings(const std::vector<std::string> &chars, size_t count) {
+  std::mt19937_64 rng(20240601);
+  std::string json = "[";
+  for (size_t i = 0; i < count; i++) {
+    if (i > 0) json += ',';
+    json += '"';
+    size_t len = 4 + rng() % 60;
+    for (size_t j = 0; j < len; j++) json += chars[rng() % chars.size()];
+    json += '"';
+  }
+  json += "]";
+  return json;
+}
+
+std::string makeAscii(size_t count) {
+  std::vector<std::string> chars;
+  for (char ch = 'a'; ch <= 'z'; ch++) chars.emplace_back(1, ch);
+  chars.emplace_back(" ");
+  return makeStrings(chars, count);
+}
+
+// 以中文为主 夹杂少量ASCII
+std::string makeCjk(size_t count) {
+  std::vector<std::string> chars = {"中", "文", "蛤", "淘", "宝", "购", "物",
+                                    "车", "商", "品", "价", "格", "1", "a"};
+  return makeStrings(chars, count);
+}
+
+// 只检查语法时字符串扫描占比最大 最能体现UTF-8校验的开销
+template <unsigned Flags>
+void validate(benchmark::State &s, const std::string &json) {
+  for (auto _ : s) {
+    json::StringReadStream is(json);
+    if (json::Reader::validate<Flags>(is) != json::ParseError::PARSE_OK)
+      exit(1);
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+template <unsigned Flags>
+void parse(benchmark::State &s, const std::string &json) {
+  for (auto _ : s) {
+    json::Document doc;
+    if (doc.parse<Flags>(json) != json::ParseError::PARSE_OK) exit(1);
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+void BM_validate(benchmark::State &s, std::string json) {
+  validate<json::kParseDefaultFlags>(s, json);
+}
+
+void BM_validate_utf8(benchmark::State &s, std::string json) {
+  validate<kUtf8Flags>(s, json);
+}
+
+void BM_parse(benchmark::State &s, std::string json) {
+  parse<json::kParseDefaultFlags>(s, json);
+}
+
+void BM_parse_utf8(benchmark::State &s, std::string json) {
+  parse<kUtf8Flags>(s, json);
+}
+
+BENCHMARK_CAPTURE(BM_validate, ascii, makeAscii(20000));
+BENCHMARK_CAPTURE(BM_validate_utf8, ascii, makeAscii(20000));
+BENCHMARK_CAPTURE(BM_validate, cjk, makeCjk(20000));
+BENCHMARK_CAPTURE(BM_validate_utf8, cjk, makeCjk(20000));
+BENCHMARK_CAPTURE(BM_validate, taobao,
+                  readFile("../../bench/taobao/cart.json"));
+BENCHMARK_CAPTURE(BM_validate_utf8, taobao,
+                  readFile("../../bench/taobao/cart.json"));
+BENCHMARK_CAPTURE(BM_parse, taobao, readFile("../../bench/taobao/cart.json"));
+BENCHMARK_CAPTURE(BM_parse_utf8, taobao,
+                  readFile("../../bench/taobao/cart.json"));
+
+BENCHMARK_MAIN();
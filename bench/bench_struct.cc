@@ -0,0 +1,204 @@
+#include <benchmark/benchmark.h>
+
+#include <Document.hpp>
+#include <StringWriteStream.hpp>
+#include <StructMapping.hpp>
+#include <Writer.hpp>
+#include <random>
+
+using namespace goa;
+
+namespace cart {
+
+struct Sku {
+  std::string title;
+  std::string skuId;
+  bool editable = false;
+};
+
+struct Item {
+  std::string id;
+  std::string title;
+  int64_t sellerId = 0;
+  double price = 0;
+  int quantity = 0;
+  bool valid = false;
+  std::vector<std::string> operate;
+  std::optional<Sku> sku;
+};
+
+// 只关心其中两个字段 其余的全部跳过
+struct Brief {
+  std::string id;
+  double price = 0;
+};
+
+GOA_JSON_FIELDS(Sku, title, skuId, editable)
+GOA_JSON_FIELDS(Item, id, title, sellerId, price, quantity, valid, operate,
+                sku)
+GOA_JSON_FIELDS(Brief, id, price)
+
+}  // namespace cart
+
+// 仿照cart.json中itemv2的数组 每个元素还带有结构体中没有的字段
+std::string makeItems(size_t count) {
+  std::mt19937_64 rng(20240601);
+  std::string json = "[";
+  for (size_t i = 0; i < count; i++) {
+    if (i > 0) json += ',';
+    std::string id = std::to_string(227462292832 + rng() % 1000000);
+    double price = static_cast<double>(rng() % 10000) / 100;
+    json += "{\"id\":\"" + id + "\",\"tag\":\"itemv2\",\"title\":\"" +
+            "洛纳丹迪红米2a手机壳红米2保护套硅胶" + std::to_string(i) +
+            "\",\"sellerId\":" + std::to_string(2396671881 + rng() % 1000) +
+            ",\"price\":" + std::to_string(price) +
+            ",\"quantity\":" + std::to_string(rng() % 10) +
+            ",\"valid\":true,\"operate\":[\"edit\",\"addFavor\",\"delete\"]"
+            ",\"pic\":\"//img.alicdn.com/bao/uploaded/i3/2396671881/"
+            "TB2d9cddVXXXXclXXXXXXXXXXXX_!!2396671881.jpg_sum.jpg\"";
+    if (rng() % 4 != 0)
+      json += ",\"sku\":{\"title\":\"颜色分类:红米2彩边蓝小雄\",\"status\":"
+              "\"CAN_CHANGE_SKU\",\"skuId\":\"3103876140130\","
+              "\"areaId\":\"310101\",\"editable\":true}";
+    json += ",\"pay\":{\"totalTitle\":\"￥39.60\",\"total\":3960,"
+            "\"originTitle\":\"￥14.00\",\"origin\":1400,\"now\":990}}";
+  }
+  json += "]";
+  return json;
+}
+
+// 以下为解析到Document后手工逐个取出字段的写法
+template <typename Get>
+void extract(const json::Value &object, std::string_view key, Get get) {
+  auto it = object.findMember(key);
+  if (it != object.endMember()) get(it->value);
+}
+
+cart::Item toItem(const json::Value &object) {
+  cart::Item item;
+  extract(object, "id", [&](auto &v) { item.id = v.getString(); });
+  extract(object, "title", [&](auto &v) { item.title = v.getString(); });
+  extract(object, "sellerId", [&](auto &v) { item.sellerId = v.getInt64(); });
+  extract(object, "price", [&](auto &v) { item.price = v.getDouble(); });
+  extract(object, "quantity", [&](auto &v) { item.quantity = v.getInt32(); });
+  extract(object, "valid", [&](auto &v) { item.valid = v.getBool(); });
+  extract(object, "operate", [&](auto &v) {
+    for (auto &op : v.getArray()) item.operate.push_back(op.getString());
+  });
+  extract(object, "sku", [&](auto &v) {
+    cart::Sku &sku = item.sku.emplace();
+    extract(v, "title", [&](auto &s) { sku.title = s.getString(); });
+    extract(v, "skuId", [&](auto &s) { sku.skuId = s.getString(); });
+    extract(v, "editable", [&](auto &s) { sku.editable = s.getBool(); });
+  });
+  return item;
+}
+
+cart::Brief toBrief(const json::Value &object) {
+  cart::Brief brief;
+  extract(object, "id", [&](auto &v) { brief.id = v.getString(); });
+  extract(object, "price", [&](auto &v) { brief.price = v.getDouble(); });
+  return brief;
+}
+
+template <typename T, typename Convert>
+void document(benchmark::State &s, const std::string &json, Convert convert) {
+  for (auto _ : s) {
+    json::Document doc;
+    if (doc.parse(json) != json::ParseError::PARSE_OK) exit(1);
+    std::vector<T> items;
+    for (auto &value : doc.getArray()) items.push_back(convert(value));
+    benchmark::DoNotOptimize(items.data());
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+template <typename T>
+void typed(benchmark::State &s, const std::string &json) {
+  for (auto _ : s) {
+    std::vector<T> items;
+    if (json::parseStruct(json, items) != json::ParseError::PARSE_OK) exit(1);
+    benchmark::DoNotOptimize(items.data());
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+void BM_document_item(benchmark::State &s, std::string json) {
+  document<cart::Item>(s, json, toItem);
+}
+
+void BM_struct_item(benchmark::State &s, std::string json) {
+  typed<cart::Item>(s, json);
+}
+
+void BM_document_brief(benchmark::State &s, std::string json) {
+  document<cart::Brief>(s, json, toBrief);
+}
+
+void BM_struct_brief(benchmark::State &s, std::string json) {
+  typed<cart::Brief>(s, json);
+}
+
+// 以下为先构造Value树再调用writeTo的写法
+json::Value toValue(const cart::Item &item) {
+  json::Value value(json::ValueType::TYPE_OBJECT);
+  value.addMember("id", std::string_view(item.id));
+  value.addMember("title", std::string_view(item.title));
+  value.addMember("sellerId", item.sellerId);
+  value.addMember("price", item.price);
+  value.addMember("quantity", item.quantity);
+  value.addMember("valid", item.valid);
+  json::Value operate(json::ValueType::TYPE_ARRAY);
+  for (auto &op : item.operate) operate.addValue(json::Value(op.data()));
+  value.addMember("operate", std::move(operate));
+  if (item.sku.has_value()) {
+    json::Value sku(json::ValueType::TYPE_OBJECT);
+    sku.addMember("title", std::string_view(item.sku->title));
+    sku.addMember("skuId", std::string_view(item.sku->skuId));
+    sku.addMember("editable", item.sku->editable);
+    value.addMember("sku", std::move(sku));
+  } else {
+    value.addMember("sku", json::Value());
+  }
+  return value;
+}
+
+std::vector<cart::Item> makeStructs(size_t count) {
+  std::vector<cart::Item> items;
+  if (json::parseStruct(makeItems(count), items) != json::ParseError::PARSE_OK)
+    exit(1);
+  return items;
+}
+
+void BM_value_write(benchmark::State &s, std::vector<cart::Item> items) {
+  size_t bytes = 0;
+  for (auto _ : s) {
+    json::Value root(json::ValueType::TYPE_ARRAY);
+    for (auto &item : items) root.addValue(toValue(item));
+    json::StringWriteStream os;
+    json::Writer writer(os);
+    root.writeTo(writer);
+    bytes = os.getStringView().size();
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * bytes));
+}
+
+void BM_struct_write(benchmark::State &s, std::vector<cart::Item> items) {
+  size_t bytes = 0;
+  for (auto _ : s) {
+    json::StringWriteStream os;
+    json::Writer writer(os);
+    json::writeStruct(writer, items);
+    bytes = os.getStringView().size();
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * bytes));
+}
+
+BENCHMARK_CAPTURE(BM_document_item, items, makeItems(2000));
+BENCHMARK_CAPTURE(BM_struct_item, items, makeItems(2000));
+BENCHMARK_CAPTURE(BM_document_brief, items, makeItems(2000));
+BENCHMARK_CAPTURE(BM_struct_brief, items, makeItems(2000));
+BENCHMARK_CAPTURE(BM_value_write, items, makeStructs(2000));
+BENCHMARK_CAPTURE(BM_struct_write, items, makeStructs(2000));
+
+BENCHMARK_MAIN();
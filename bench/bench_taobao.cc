@@ -1,12 +1,31 @@
 #include <benchmark/benchmark.h>
 
+#include <AsyncFileReadStream.hpp>
+#include <BufferedFileReadStream.hpp>
 #include <Document.hpp>
 #include <FileReadStream.hpp>
+#include <KeyDictionary.hpp>
+#include <MmapReadStream.hpp>
+#include <OnDemand.hpp>
+#include <PushParser.hpp>
+#include <StringPool.hpp>
 #include <StringWriteStream.hpp>
+#include <StructuralReader.hpp>
 #include <Writer.hpp>
+#include <fstream>
+#include <memory_resource>
+#include <sstream>
 
 using namespace goa;
 
+std::string readFile(const char *path) {
+  std::ifstream in(path);
+  if (!in) exit(1);
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  return buffer.str();
+}
+
 template <class... ExtraArgs>
 void BM_read(benchmark::State &s, ExtraArgs &&... extra_args) {
   for (auto _ : s) {
@@ -30,6 +49,422 @@ void BM_read_parse(benchmark::State &s, ExtraArgs &&... extra_args) {
       exit(1);
     }
   }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() *
+                                           readFile(extra_args...).size()));
+}
+
+// 直接解析映射到内存的文件 不拷贝文件内容
+template <class... ExtraArgs>
+void BM_mmap_parse(benchmark::State &s, ExtraArgs &&... extra_args) {
+  for (auto _ : s) {
+    FILE *input = fopen(extra_args..., "r");
+    if (input == nullptr) exit(1);
+    json::Document doc;
+    json::MmapReadStream is(input);
+    fclose(input);
+    if (doc.parseStream(is) != json::ParseError::PARSE_OK) {
+      exit(1);
+    }
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() *
+                                           readFile(extra_args...).size()));
+}
+
+// 边读边解析 只占用一块固定大小的缓冲区
+template <class... ExtraArgs>
+void BM_read_parse_buffered(benchmark::State &s, ExtraArgs &&... extra_args) {
+  for (auto _ : s) {
+    FILE *input = fopen(extra_args..., "r");
+    if (input == nullptr) exit(1);
+    json::Document doc;
+    json::BufferedFileReadStream is(input);
+    if (doc.parseStream(is) != json::ParseError::PARSE_OK) {
+      exit(1);
+    }
+    fclose(input);
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() *
+                                           readFile(extra_args...).size()));
+}
+
+// 后台线程预读下一块 读盘与解析重叠
+template <class... ExtraArgs>
+void BM_read_parse_async(benchmark::State &s, ExtraArgs &&... extra_args) {
+  for (auto _ : s) {
+    FILE *input = fopen(extra_args..., "r");
+    if (input == nullptr) exit(1);
+    json::Document doc;
+    {
+      json::AsyncFileReadStream is(input);
+      if (doc.parseStream(is) != json::ParseError::PARSE_OK) {
+        exit(1);
+      }
+    }
+    fclose(input);
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() *
+                                           readFile(extra_args...).size()));
+}
+
+// 以下两项输入均已在内存中 只比较两种解析器本身
+template <class... ExtraArgs>
+void BM_parse(benchmark::State &s, ExtraArgs &&... extra_args) {
+  std::string json = readFile(extra_args...);
+  for (auto _ : s) {
+    json::Document doc;
+    json::StringReadStream is(json);
+    if (json::Reader::parse(is, doc) != json::ParseError::PARSE_OK) {
+      exit(1);
+    }
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+template <class... ExtraArgs>
+void BM_parse_structural(benchmark::State &s, ExtraArgs &&... extra_args) {
+  std::string json = readFile(extra_args...);
+  json::StructuralIndex index;
+  for (auto _ : s) {
+    json::Document doc;
+    json::StringReadStream is(json);
+    if (json::StructuralReader::parse(is, doc, index) !=
+        json::ParseError::PARSE_OK) {
+      exit(1);
+    }
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+// 模拟从socket分段读到的输入 每次4KB
+template <class... ExtraArgs>
+void BM_parse_push(benchmark::State &s, ExtraArgs &&... extra_args) {
+  std::string json = readFile(extra_args...);
+  for (auto _ : s) {
+    json::Document doc;
+    json::PushParser<json::Document> parser(doc);
+    for (size_t i = 0; i < json.size(); i += 4096) {
+      if (parser.feed(std::string_view(json).substr(i, 4096)) !=
+          json::ParseError::PARSE_OK) {
+        exit(1);
+      }
+    }
+    if (parser.finish() != json::ParseError::PARSE_OK) exit(1);
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+// 只校验 不建树
+template <class... ExtraArgs>
+void BM_validate(benchmark::State &s, ExtraArgs &&... extra_args) {
+  std::string json = readFile(extra_args...);
+  for (auto _ : s) {
+    json::StringReadStream is(json);
+    if (json::Reader::validate(is) != json::ParseError::PARSE_OK) {
+      exit(1);
+    }
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+// 截断的输入 衡量拒绝格式错误的请求的开销
+template <class... ExtraArgs>
+void BM_parse_error(benchmark::State &s, ExtraArgs &&... extra_args) {
+  std::string json = readFile(extra_args...).substr(0, 256);
+  for (auto _ : s) {
+    json::Document doc;
+    json::StringReadStream is(json);
+    if (json::Reader::parse(is, doc) == json::ParseError::PARSE_OK) {
+      exit(1);
+    }
+  }
+}
+
+// 每次解析使用一个新的字符串池 重复的key和短字符串只分配一次
+// hits为每次解析复用的次数 即少分配的字符串节点数 saved为少拷贝的字节数
+template <class... ExtraArgs>
+void BM_parse_interned(benchmark::State &s, ExtraArgs &&... extra_args) {
+  std::string json = readFile(extra_args...);
+  size_t hits = 0, saved = 0;
+  for (auto _ : s) {
+    json::StringPool pool;
+    json::Document doc;
+    if (doc.parse(json, pool) != json::ParseError::PARSE_OK) exit(1);
+    hits = pool.getHits();
+    saved = pool.getSavedBytes();
+  }
+  s.counters["hits"] = static_cast<double>(hits);
+  s.counters["saved"] = static_cast<double>(saved);
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+// 多个文档共用一个池 池中已有全部字符串 每次解析都不再分配
+template <class... ExtraArgs>
+void BM_parse_shared_pool(benchmark::State &s, ExtraArgs &&... extra_args) {
+  std::string json = readFile(extra_args...);
+  json::StringPool pool;
+  for (auto _ : s) {
+    json::Document doc;
+    if (doc.parse(json, pool) != json::ParseError::PARSE_OK) exit(1);
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+// 节点从Document持有的内存池分配 析构时整块释放
+template <class... ExtraArgs>
+void BM_parse_arena(benchmark::State &s, ExtraArgs &&... extra_args) {
+  std::string json = readFile(extra_args...);
+  for (auto _ : s) {
+    json::Document doc = json::Document::withArena();
+    if (doc.parse(json) != json::ParseError::PARSE_OK) exit(1);
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+// 调用方的内存池在每次解析后release 第一块之后的内存不再向系统申请
+template <class... ExtraArgs>
+void BM_parse_reused_arena(benchmark::State &s, ExtraArgs &&... extra_args) {
+  std::string json = readFile(extra_args...);
+  std::pmr::monotonic_buffer_resource arena;
+  for (auto _ : s) {
+    {
+      json::Document doc(&arena);
+      if (doc.parse(json) != json::ParseError::PARSE_OK) exit(1);
+    }
+    arena.release();
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+// 原地解析会改写输入 每次迭代都需重新拷贝一份缓冲区
+template <class... ExtraArgs>
+void BM_parse_insitu(benchmark::State &s, ExtraArgs &&... extra_args) {
+  std::string json = readFile(extra_args...);
+  std::string buffer;
+  for (auto _ : s) {
+    buffer = json;
+    json::Document doc;
+    if (doc.parseInsitu(buffer.data(), buffer.size()) !=
+        json::ParseError::PARSE_OK) {
+      exit(1);
+    }
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+// 只读取少数几个字段 比较完整建树和按需解析
+template <class... ExtraArgs>
+void BM_fields_document(benchmark::State &s, ExtraArgs &&... extra_args) {
+  std::string json = readFile(extra_args...);
+  for (auto _ : s) {
+    json::Document doc;
+    if (doc.parse(json) != json::ParseError::PARSE_OK) exit(1);
+    auto &data = doc["data"];
+    auto &pageMeta = data["pageMeta"];
+    auto &controlParas = data["controlParas"];
+    benchmark::DoNotOptimize(doc["api"].getStringView());
+    benchmark::DoNotOptimize(doc["ret"][0].getStringView());
+    benchmark::DoNotOptimize(pageMeta["totalCount"].getInt64());
+    benchmark::DoNotOptimize(pageMeta["pageNo"].getInt64());
+    benchmark::DoNotOptimize(pageMeta["isNext"].getBool());
+    benchmark::DoNotOptimize(pageMeta["startTimestamp"].getStringView());
+    benchmark::DoNotOptimize(data["hierarchy"]["root"].getStringView());
+    benchmark::DoNotOptimize(controlParas["smShopHost"].getStringView());
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+template <class... ExtraArgs>
+void BM_fields_ondemand(benchmark::State &s, ExtraArgs &&... extra_args) {
+  std::string json = readFile(extra_args...);
+  for (auto _ : s) {
+    json::OnDemandDocument doc(json);
+    auto data = doc["data"];
+    auto pageMeta = data["pageMeta"];
+    auto controlParas = data["controlParas"];
+    if (!pageMeta.exists()) exit(1);
+    benchmark::DoNotOptimize(doc["api"].getStringView());
+    benchmark::DoNotOptimize(doc["ret"][0].getStringView());
+    benchmark::DoNotOptimize(pageMeta["totalCount"].getInt64());
+    benchmark::DoNotOptimize(pageMeta["pageNo"].getInt64());
+    benchmark::DoNotOptimize(pageMeta["isNext"].getBool());
+    benchmark::DoNotOptimize(pageMeta["startTimestamp"].getStringView());
+    benchmark::DoNotOptimize(data["hierarchy"]["root"].getStringView());
+    benchmark::DoNotOptimize(controlParas["smShopHost"].getStringView());
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+// 只保留上面几个字段所在的路径 其余部分只校验不建树
+template <class... ExtraArgs>
+void BM_fields_projected(benchmark::State &s, ExtraArgs &&... extra_args) {
+  std::string json = readFile(extra_args...);
+  json::PathFilter filter{"/api", "/ret/0", "/data/pageMeta",
+                          "/data/hierarchy/root", "/data/controlParas"};
+  for (auto _ : s) {
+    json::Document doc;
+    if (doc.parse(json, filter) != json::ParseError::PARSE_OK) exit(1);
+    auto &data = doc["data"];
+    auto &pageMeta = data["pageMeta"];
+    auto &controlParas = data["controlParas"];
+    benchmark::DoNotOptimize(doc["api"].getStringView());
+    benchmark::DoNotOptimize(doc["ret"][0].getStringView());
+    benchmark::DoNotOptimize(pageMeta["totalCount"].getInt64());
+    benchmark::DoNotOptimize(pageMeta["pageNo"].getInt64());
+    benchmark::DoNotOptimize(pageMeta["isNext"].getBool());
+    benchmark::DoNotOptimize(pageMeta["startTimestamp"].getStringView());
+    benchmark::DoNotOptimize(data["hierarchy"]["root"].getStringView());
+    benchmark::DoNotOptimize(controlParas["smShopHost"].getStringView());
+  }
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+// 按key分派的SAX handler 统计cart.json中最常见的32个key各出现几次
+constexpr std::string_view kCartKeys[] = {
+    "id", "tag", "fields", "title", "quantity", "url", "editable", "checked",
+    "sellerId", "shopId", "valid", "bundleId", "pic", "pay", "canBatchRemove",
+    "toBuy", "settlement", "cartId", "bundleType", "exclude", "itemId", "mutex",
+    "showCheckBox", "operate", "totalTitle", "total", "origin", "nowTitle",
+    "now", "multiple", "min", "max"};
+constexpr size_t kNumCartKeys = std::size(kCartKeys);
+
+struct KeyCounter {
+  bool Null() { return true; }
+  bool Bool(bool) { return true; }
+  bool Int32(int32_t) { return true; }
+  bool Int64(int64_t) { return true; }
+  bool Double(double) { return true; }
+  bool String(std::string_view) { return true; }
+  bool StartObject() { return true; }
+  bool EndObject() { return true; }
+  bool StartArray() { return true; }
+  bool EndArray() { return true; }
+
+  size_t counts[kNumCartKeys + 1] = {};  // 最后一项为其他的key
+};
+
+// 逐个与字符串常量比较
+struct KeyComparer : KeyCounter {
+  bool Key(std::string_view key) {
+    size_t i = 0;
+    while (i < kNumCartKeys && key != kCartKeys[i]) i++;
+    counts[i]++;
+    return true;
+  }
+};
+
+// Reader在字典中查找 handler直接拿到编号
+struct KeyIdCounter : KeyCounter {
+  const json::KeyDictionary &getKeyDictionary() const { return dict; }
+  bool KeyId(size_t id, std::string_view) {
+    counts[id == json::KeyDictionary::kUnknown ? kNumCartKeys : id]++;
+    return true;
+  }
+
+  const json::KeyDictionary &dict;
+};
+
+template <typename Handler, class... ExtraArgs>
+void keys(benchmark::State &s, Handler &handler, ExtraArgs &&... extra_args) {
+  std::string json = readFile(extra_args...);
+  for (auto _ : s) {
+    json::StringReadStream is(json);
+    if (json::Reader::parse(is, handler) != json::ParseError::PARSE_OK)
+      exit(1);
+  }
+  benchmark::DoNotOptimize(handler.counts);
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+template <class... ExtraArgs>
+void BM_keys_compare(benchmark::State &s, ExtraArgs &&... extra_args) {
+  KeyComparer handler;
+  keys(s, handler, extra_args...);
+}
+
+template <class... ExtraArgs>
+void BM_keys_dictionary(benchmark::State &s, ExtraArgs &&... extra_args) {
+  json::KeyDictionary dict(
+      std::vector<std::string>(std::begin(kCartKeys), std::end(kCartKeys)));
+  KeyIdCounter handler{{}, dict};
+  keys(s, handler, extra_args...);
+}
+
+// 同样的handler交给两阶段解析器 handler本身几乎没有开销 比较两者的解析部分
+template <class... ExtraArgs>
+void BM_keys_structural(benchmark::State &s, ExtraArgs &&... extra_args) {
+  json::KeyDictionary dict(
+      std::vector<std::string>(std::begin(kCartKeys), std::end(kCartKeys)));
+  KeyIdCounter handler{{}, dict};
+  std::string json = readFile(extra_args...);
+  json::StructuralIndex index;
+  for (auto _ : s) {
+    json::StringReadStream is(json);
+    if (json::StructuralReader::parse(is, handler, index) !=
+        json::ParseError::PARSE_OK)
+      exit(1);
+  }
+  benchmark::DoNotOptimize(handler.counts);
+  s.SetBytesProcessed(static_cast<int64_t>(s.iterations() * json.size()));
+}
+
+// 逐个拷贝树中的每个节点和key 拷贝和析构都要增减引用计数
+void copyEach(const json::Value &value) {
+  json::Value copy = value;
+  benchmark::DoNotOptimize(copy);
+  if (value.isArray()) {
+    for (auto &element : value.getArray()) copyEach(element);
+  } else if (value.isObject()) {
+    for (auto &member : value.getObject()) {
+      json::Value key = member.key;
+      benchmark::DoNotOptimize(key);
+      copyEach(member.value);
+    }
+  }
+}
+
+// 把每个节点拷贝进一个数组后整体释放 另有数组扩容的开销
+void collectAll(const json::Value &value, json::Value &out) {
+  out.addValue(value);
+  if (value.isArray()) {
+    for (auto &element : value.getArray()) collectAll(element, out);
+  } else if (value.isObject()) {
+    for (auto &member : value.getObject()) collectAll(member.value, out);
+  }
+}
+
+template <typename Copy>
+void copyDocument(benchmark::State &s, const char *path,
+                  json::RefCountPolicy policy, Copy copy) {
+  std::string json = readFile(path);
+  json::Document doc(policy);
+  if (doc.parse(json) != json::ParseError::PARSE_OK) exit(1);
+  for (auto _ : s) copy(doc);
+}
+
+template <class... ExtraArgs>
+void BM_copy_atomic(benchmark::State &s, ExtraArgs &&... extra_args) {
+  copyDocument(s, extra_args..., json::RefCountPolicy::ATOMIC, copyEach);
+}
+
+template <class... ExtraArgs>
+void BM_copy_local(benchmark::State &s, ExtraArgs &&... extra_args) {
+  copyDocument(s, extra_args..., json::RefCountPolicy::LOCAL, copyEach);
+}
+
+void collect(const json::Value &doc) {
+  json::Value out(json::ValueType::TYPE_ARRAY);
+  collectAll(doc, out);
+  benchmark::DoNotOptimize(out);
+}
+
+template <class... ExtraArgs>
+void BM_collect_atomic(benchmark::State &s, ExtraArgs &&... extra_args) {
+  copyDocument(s, extra_args..., json::RefCountPolicy::ATOMIC, collect);
+}
+
+template <class... ExtraArgs>
+void BM_collect_local(benchmark::State &s, ExtraArgs &&... extra_args) {
+  copyDocument(s, extra_args..., json::RefCountPolicy::LOCAL, collect);
 }
 
 template <class... ExtraArgs>
@@ -57,6 +492,51 @@ BENCHMARK_CAPTURE(BM_read, taobao, jsonDir.c_str())
     ->Unit(benchmark::kMillisecond);
 BENCHMARK_CAPTURE(BM_read_parse, taobao, jsonDir.c_str())
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_mmap_parse, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_read_parse_buffered, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_read_parse_async, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_parse, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_parse_structural, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_parse_interned, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_parse_shared_pool, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_parse_arena, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_parse_reused_arena, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_parse_insitu, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_parse_push, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_validate, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_parse_error, taobao, jsonDir.c_str());
+BENCHMARK_CAPTURE(BM_fields_document, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_fields_ondemand, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_fields_projected, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_keys_compare, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_keys_dictionary, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_keys_structural, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_copy_atomic, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_copy_local, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_collect_atomic, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_collect_local, taobao, jsonDir.c_str())
+    ->Unit(benchmark::kMicrosecond);
 BENCHMARK_CAPTURE(BM_read_parse_write, taobao, jsonDir.c_str())
     ->Unit(benchmark::kMillisecond);
 
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "noncopyable.hpp"
+
+namespace goa {
+
+namespace json {
+
+/*
+预读的文件流 后台线程读入下一块数据的同时 Reader解析当前这一块
+冷缓存下从磁盘解析大文件时 总耗时接近读盘与解析两者中较大的一个 而不是两者之和
+
+接口和用法与BufferedFileReadStream相同 解析期间文件须保持打开
+构造后文件只由后台线程读取 在流析构之前不能再使用
+- 当前块读完时 与后台读好的一块交换 再让后台线程读入下一块
+- 解析数字期间Reader设置标记 标记之后的数据要与新的一块拼接 此时才需拷贝
+*/
+class AsyncFileReadStream : noncopyable {
+ public:
+  static constexpr size_t kDefaultBufferSize = 256 * 1024;
+
+  class ConstIterator {
+   public:
+    ConstIterator(const AsyncFileReadStream *stream, size_t offset)
+        : stream_(stream), offset_(offset) {}
+
+    // 只能访问缓冲区中仍保留的数据
+    const char &operator*() const {
+      assert(offset_ >= stream_->base_ &&
+             offset_ < stream_->base_ + stream_->buffer_.size());
+      return stream_->buffer_[offset_ - stream_->base_];
+    }
+    std::ptrdiff_t operator-(const ConstIterator &rhs) const {
+      return static_cast<std::ptrdiff_t>(offset_ - rhs.offset_);
+    }
+
+   private:
+    const AsyncFileReadStream *stream_;
+    size_t offset_;
+  };
+
+  explicit AsyncFileReadStream(FILE *input,
+                               size_t bufferSize = kDefaultBufferSize)
+      : input_(input),
+        chunkSize_(bufferSize == 0 ? 1 : bufferSize),
+        ahead_(chunkSize_),
+        thread_([this] { readLoop(); }) {}
+
+  ~AsyncFileReadStream() {
+    {
+      std::lock_guard lock(mutex_);
+      stop_ = true;
+    }
+    cond_.notify_all();
+    thread_.join();
+  }
+
+  bool hasNext() { return cur_ != end_ || refill(); }
+  char peek() { return hasNext() ? buffer_[cur_] : '\0'; }
+  ConstIterator getConstIter() const {
+    return ConstIterator(this, base_ + cur_);
+  }
+  char next() { return hasNext() ? buffer_[cur_++] : '\0'; }
+  void assertNext(char c) {
+    assert(peek() == c);
+    next();
+  }
+
+  // 批量访问接口 返回缓冲区中尚未读取的连续字节 配合skip一次跳过多个字节
+  std::string_view getRemaining() const {
+    return std::string_view(buffer_.data() + cur_, end_ - cur_);
+  }
+  void skip(size_t n) {
+    assert(n <= end_ - cur_);
+    cur_ += n;
+  }
+
+  // 从当前位置起的数据在清除标记前不会被丢弃
+  void setMark() { mark_ = cur_; }
+  void clearMark() { mark_ = kNoMark; }
+
+ private:
+  static constexpr size_t kNoMark = static_cast<size_t>(-1);
+
+  // 取走后台读好的一块 没有标记时直接交换缓冲区
+  bool refill() {
+    if (eof_) return false;
+    size_t n;
+    {
+      std::unique_lock lock(mutex_);
+      cond_.wait(lock, [this] { return ready_; });
+      n = aheadSize_;
+    }
+    if (n == 0) {
+      eof_ = true;
+      return false;
+    }
+
+    size_t keep = mark_ == kNoMark ? cur_ : mark_;
+    size_t kept = end_ - keep;
+    if (kept == 0) {
+      buffer_.swap(ahead_);
+    } else {
+      std::memmove(buffer_.data(), buffer_.data() + keep, kept);
+      buffer_.resize(kept + n);
+      std::memcpy(buffer_.data() + kept, ahead_.data(), n);
+    }
+    base_ += keep;
+    cur_ -= keep;
+    if (mark_ != kNoMark) mark_ -= keep;
+    end_ = kept + n;
+
+    // ahead_已空出 让后台线程开始读下一块
+    ahead_.resize(chunkSize_);
+    {
+      std::lock_guard lock(mutex_);
+      ready_ = false;
+    }
+    cond_.notify_all();
+    return true;
+  }
+
+  void readLoop() {
+    while (true) {
+      {
+        std::unique_lock lock(mutex_);
+        cond_.wait(lock, [this] { return stop_ || !ready_; });
+        if (stop_) return;
+      }
+      size_t n = fread(ahead_.data(), 1, ahead_.size(), input_);
+      {
+        std::lock_guard lock(mutex_);
+        aheadSize_ = n;
+        ready_ = true;
+      }
+      cond_.notify_all();
+      if (n == 0) return;
+    }
+  }
+
+  FILE *input_;
+  const size_t chunkSize_;
+  std::vector<char> buffer_;  // 正在解析的数据
+  std::vector<char> ahead_;   // 后台线程读入的下一块
+  size_t base_ = 0;           // buffer_[0]在文件中的位置
+  size_t cur_ = 0;            // 以下均为buffer_中的下标
+  size_t end_ = 0;
+  size_t mark_ = kNoMark;
+  bool eof_ = false;
+
+  std::mutex mutex_;  // 保护以下的状态 ahead_由ready_决定归哪个线程使用
+  std::condition_variable cond_;
+  size_t aheadSize_ = 0;
+  bool ready_ = false;
+  bool stop_ = false;
+  std::thread thread_;  // 最后构造 启动时其余成员均已初始化
+};
+
+}  // namespace json
+
+}  // namespace goa
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "noncopyable.hpp"
+
+namespace goa {
+
+namespace json {
+
+/*
+边读边解析的文件流 只使用一块固定大小的缓冲区 读完后从文件中重新填充
+与FileReadStream不同 解析期间文件须保持打开 内存占用与文件大小无关
+
+- getRemaining只返回缓冲区中尚未读取的部分 读到缓冲区末尾时
+  hasNext/peek/next会自动重新填充 Reader对空白和数字的批量扫描会跨缓冲区继续
+- 迭代器记录在文件中的绝对位置 两个迭代器相减得到字节数 可跨越重新填充
+- 解析数字期间Reader会设置标记 重新填充时保留标记之后的数据
+  使整个数字在缓冲区中连续 数字比缓冲区还长时缓冲区加倍
+*/
+class BufferedFileReadStream : noncopyable {
+ public:
+  static constexpr size_t kDefaultBufferSize = 64 * 1024;
+
+  class ConstIterator {
+   public:
+    ConstIterator(const BufferedFileReadStream *stream, size_t offset)
+        : stream_(stream), offset_(offset) {}
+
+    // 只能访问缓冲区中仍保留的数据
+    const char &operator*() const {
+      assert(offset_ >= stream_->base_ &&
+             offset_ < stream_->base_ + stream_->buffer_.size());
+      return stream_->buffer_[offset_ - stream_->base_];
+    }
+    std::ptrdiff_t operator-(const ConstIterator &rhs) const {
+      return static_cast<std::ptrdiff_t>(offset_ - rhs.offset_);
+    }
+
+   private:
+    const BufferedFileReadStream *stream_;
+    size_t offset_;
+  };
+
+  explicit BufferedFileReadStream(FILE *input,
+                                  size_t bufferSize = kDefaultBufferSize)
+      : input_(input), buffer_(bufferSize == 0 ? 1 : bufferSize) {}
+
+  bool hasNext() { return cur_ != end_ || refill(); }
+  char peek() { return hasNext() ? buffer_[cur_] : '\0'; }
+  ConstIterator getConstIter() const {
+    return ConstIterator(this, base_ + cur_);
+  }
+  char next() { return hasNext() ? buffer_[cur_++] : '\0'; }
+  void assertNext(char c) {
+    assert(peek() == c);
+    next();
+  }
+
+  // 批量访问接口 返回缓冲区中尚未读取的连续字节 配合skip一次跳过多个字节
+  std::string_view getRemaining() const {
+    return std::string_view(buffer_.data() + cur_, end_ - cur_);
+  }
+  void skip(size_t n) {
+    assert(n <= end_ - cur_);
+    cur_ += n;
+  }
+
+  // 从当前位置起的数据在清除标记前不会被丢弃
+  void setMark() { mark_ = cur_; }
+  void clearMark() { mark_ = kNoMark; }
+
+ private:
+  static constexpr size_t kNoMark = static_cast<size_t>(-1);
+
+  // 丢弃已读取的数据 把保留的部分移到开头后读入新数据
+  bool refill() {
+    if (eof_) return false;
+    size_t keep = mark_ == kNoMark ? cur_ : mark_;
+    size_t kept = end_ - keep;
+    if (kept == buffer_.size()) buffer_.resize(buffer_.size() * 2);
+    std::memmove(buffer_.data(), buffer_.data() + keep, kept);
+    base_ += keep;
+    cur_ -= keep;
+    if (mark_ != kNoMark) mark_ -= keep;
+    end_ = kept;
+
+    size_t n = fread(buffer_.data() + end_, 1, buffer_.size() - end_, input_);
+    if (n == 0) eof_ = true;
+    end_ += n;
+    return cur_ != end_;
+  }
+
+  FILE *input_;
+  std::vector<char> buffer_;
+  size_t base_ = 0;  // buffer_[0]在文件中的位置
+  size_t cur_ = 0;   // 以下均为buffer_中的下标
+  size_t end_ = 0;
+  size_t mark_ = kNoMark;
+  bool eof_ = false;
+};
+
+}  // namespace json
+
+}  // namespace goa
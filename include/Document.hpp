@@ -1,10 +1,16 @@
 #pragma once
 
+#include <memory>
+#include <memory_resource>
+#include <string>
 #include <string_view>
 #include <type_traits>
 
 #include "FileReadStream.hpp"
+#include "InsituStringStream.hpp"
+#include "PathFilter.hpp"
 #include "Reader.hpp"
+#include "StringPool.hpp"
 #include "StringReadStream.hpp"
 #include "Value.hpp"
 
@@ -23,21 +29,126 @@ Document的内部依赖于Reader::parse进行json解析 并自己实现了handle
 */
 class Document : public Value {
  public:
-  ParseError parse(const std::string_view &json) {
+  static constexpr size_t kDefaultArenaSize = 64 * 1024;
+
+  Document() = default;
+
+  // 只在一个线程内使用的文档可用RefCountPolicy::LOCAL
+  // 解析出的节点在拷贝和析构时不再需要原子操作
+  explicit Document(RefCountPolicy policy) : policy_(policy) {}
+
+  // 解析出的节点及其数据都从resource分配 如调用方每个请求复用的内存池
+  // resource须比Document(以及从中拷贝出的Value)活得久
+  explicit Document(std::pmr::memory_resource *resource,
+                    RefCountPolicy policy = RefCountPolicy::ATOMIC)
+      : resource_(resource), policy_(policy) {}
+
+  /*
+  节点从Document自己持有的单调内存池中分配 只增不减 析构时整块释放
+  省去解析时每个节点的new和析构时逐个的析构 适合解析后只读的文档
+  内存池随Document(及其拷贝)一同释放 从中拷贝出的Value不能活得更久
+  最后一个持有内存池的Document析构时不再遍历树 节点随内存池一起丢弃
+  因此之后插入树中的string array object也须从getMemoryResource()分配
+  initialSize为第一块的大小 之后的块按倍数增长
+  */
+  static Document withArena(size_t initialSize = kDefaultArenaSize,
+                            RefCountPolicy policy = RefCountPolicy::ATOMIC) {
+    Document doc(policy);
+    doc.arena_ =
+        std::make_shared<std::pmr::monotonic_buffer_resource>(initialSize);
+    doc.resource_ = doc.arena_.get();
+    return doc;
+  }
+
+  Document(const Document &) = default;
+  Document(Document &&) = default;
+  Document &operator=(const Document &) = default;
+  Document &operator=(Document &&) = default;
+
+  std::pmr::memory_resource *getMemoryResource() const { return resource_; }
+  RefCountPolicy getRefCountPolicy() const { return policy_; }
+
+  // 基类Value在成员之后析构 不能再访问内存池中的节点
+  // 内存池只剩这一个持有者时 树中(以及解析失败时key_中)的节点直接丢弃
+  // 其他拷贝仍在时照常减少引用计数 内存池此时不会释放
+  ~Document() {
+    if (arena_ && arena_.use_count() == 1) {
+      stack_.clear();
+      key_.abandon();
+      abandon();
+    }
+  }
+
+  // Flags为ParseFlag的组合 见Reader
+  template <unsigned Flags = kParseDefaultFlags>
+  ParseResult parse(const std::string_view &json) {
     StringReadStream is(json);
-    return parseStream(is);
+    return parseStream<Flags>(is);
   }
 
-  template <typename ReadStream,
-            typename = std::enable_if_t<
-                std::is_same<ReadStream, StringReadStream>::value ||
-                std::is_same<ReadStream, FileReadStream>::value>>
-  ParseError parseStream(ReadStream &is) {
-    return Reader::parse(is, *this);
+  template <unsigned Flags = kParseDefaultFlags, typename ReadStream,
+            typename = std::enable_if_t<isReadStream<ReadStream>>>
+  ParseResult parseStream(ReadStream &is) {
+    return Reader::parse<Flags>(is, *this);
+  }
+
+  /*
+  解析时用pool对key和短字符串去重 重复的字符串共享同一个节点
+  每次解析传入新的池 去重范围即为这一次解析 也可让多个Document共用一个池
+  pool只需在解析期间有效
+  pool须以与Document相同的resource和policy构造 如
+  StringPool pool(64, doc.getMemoryResource(), doc.getRefCountPolicy())
+  不一致时不经过池 字符串由Document自己分配
+  池中保存着节点的拷贝 Document持有内存池时 池须先于Document清空或销毁
+  */
+  template <unsigned Flags = kParseDefaultFlags>
+  ParseResult parse(const std::string_view &json, StringPool &pool) {
+    StringReadStream is(json);
+    return parseStream<Flags>(is, pool);
   }
 
-  ParseError parse(const char *json, size_t len) {
-    return parse(std::string_view(json, len));
+  template <unsigned Flags = kParseDefaultFlags, typename ReadStream,
+            typename = std::enable_if_t<isReadStream<ReadStream>>>
+  ParseResult parseStream(ReadStream &is, StringPool &pool) {
+    bool matches = pool.getMemoryResource() == resource_ &&
+                   pool.getRefCountPolicy() == policy_;
+    assert(matches && "StringPool allocates differently from Document");
+    pool_ = matches ? &pool : nullptr;
+    ParseResult result = Reader::parse<Flags>(is, *this);
+    pool_ = nullptr;
+    return result;
+  }
+
+  template <unsigned Flags = kParseDefaultFlags>
+  ParseResult parse(const char *json, size_t len) {
+    return parse<Flags>(std::string_view(json, len));
+  }
+
+  // 只保留filter中路径所指的值 其余部分在解析时直接跳过
+  template <unsigned Flags = kParseDefaultFlags>
+  ParseResult parse(const std::string_view &json, const PathFilter &filter) {
+    StringReadStream is(json);
+    return Reader::parse<Flags>(is, *this, filter);
+  }
+
+  /*
+  原地解析：字符串在json缓冲区内就地解码 Document中的字符串直接指向缓冲区
+  省去每个string和key的一次堆分配和拷贝 缓冲区内容会被改写
+  调用方需保证缓冲区比Document(以及从中拷贝出的Value)活得久
+  */
+  template <unsigned Flags = kParseDefaultFlags>
+  ParseResult parseInsitu(char *json, size_t len) {
+    insituBegin_ = json;
+    insituEnd_ = json + len;
+    InsituStringStream is(json, len);
+    return Reader::parse<Flags>(is, *this);
+  }
+
+  // 由Document接管缓冲区 缓冲区随Document(及其拷贝)一同释放
+  template <unsigned Flags = kParseDefaultFlags>
+  ParseResult parseInsitu(std::string &&json) {
+    insituBuffer_ = std::make_shared<std::string>(std::move(json));
+    return parseInsitu<Flags>(insituBuffer_->data(), insituBuffer_->size());
   }
 
  public:
@@ -62,18 +173,18 @@ class Document : public Value {
     return true;
   }
   bool String(const std::string_view &s) {
-    addValue(Value(s));
+    addValue(makeString(s));
     return true;
   }
 
   bool StartObject() {
-    auto value = addValue(Value(ValueType::TYPE_OBJECT));
+    auto value = addValue(Value(ValueType::TYPE_OBJECT, resource_, policy_));
     stack_.emplace_back(
         value);  // 仅在遇到 { 时, 将当前对象压入栈  ;  遇到 } 时, EndObject出栈
     return true;
   }
   bool Key(std::string_view s) {
-    addValue(Value(s));
+    addValue(makeString(s));
     return true;
   }
   bool EndObject() {
@@ -84,7 +195,7 @@ class Document : public Value {
   }
 
   bool StartArray() {
-    auto value = addValue(Value(ValueType::TYPE_ARRAY));
+    auto value = addValue(Value(ValueType::TYPE_ARRAY, resource_, policy_));
     stack_.emplace_back(value);
     return true;
   }
@@ -96,6 +207,14 @@ class Document : public Value {
   }
 
  private:
+  // 原地解析时 落在缓冲区内的字符串直接引用 不再拷贝
+  Value makeString(std::string_view s) const {
+    if (s.data() >= insituBegin_ && s.data() + s.size() <= insituEnd_)
+      return Value::borrowString(s);
+    if (pool_ != nullptr) return pool_->intern(s);
+    return Value(s, resource_, policy_);
+  }
+
   // reader每解析一个元素 都需要添加到Document对象中
   // 对于object和array  需要维护一个栈  记录当前json对象的层级
   Value *addValue(Value &&value) {
@@ -105,12 +224,9 @@ class Document : public Value {
       assert(!stack_.empty() && "root not singular");
     else {
       // Document继承自Value Value默认初始为TYPE_NULL
-      assert(type_ == ValueType::TYPE_NULL);
+      assert(isNull());
       seeValue_ = true;
-      type_ = value.type_;
-      a_ = value.a_;  // 移动赋值  需要释放原来的内存
-      value.type_ = ValueType::TYPE_NULL;
-      value.a_ = nullptr;
+      Value::operator=(std::move(value));
       return this;
     }
 
@@ -156,6 +272,15 @@ class Document : public Value {
   std::vector<Level> stack_;
   Value key_;
   bool seeValue_ = false;
+
+  const char *insituBegin_ = nullptr;
+  const char *insituEnd_ = nullptr;
+  std::shared_ptr<std::string> insituBuffer_;
+  StringPool *pool_ = nullptr;  // 仅在parse期间非空
+
+  std::pmr::memory_resource *resource_ = nullptr;  // 为空时使用new/delete
+  std::shared_ptr<std::pmr::monotonic_buffer_resource> arena_;
+  RefCountPolicy policy_ = RefCountPolicy::ATOMIC;
 };
 
 }  // namespace json
@@ -1,6 +1,9 @@
 #pragma once
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <exception>
+#include <string_view>
 
 namespace goa {
 
@@ -21,7 +24,9 @@ namespace json {
   XX(MISS_KEY, "miss key")                                         \
   XX(MISS_COLON, "miss colon")                                     \
   XX(MISS_COMMA_OR_CURLY_BRACKET, "miss comma or curly bracket")   \
-  XX(USER_STOPPED, "user stopped parse")
+  XX(USER_STOPPED, "user stopped parse")                           \
+  XX(DEPTH_EXCEEDED, "nesting too deep")                           \
+  XX(BAD_UTF8, "invalid utf-8")
 
 // 枚举ERROR_MAP中的错误类型
 // {PARSE_OK,PARSE_ROOT_NOT_SINGULAR,....}
@@ -60,6 +65,40 @@ class Exception : public std::exception {
   ParseError err_;
 };
 
+/*
+解析结果 包含错误类型和解析停止处相对输入起点的字节偏移
+可与ParseError相互隐式转换 兼容原先直接返回ParseError的用法
+行号和列号只在调用时根据输入计算 解析过程中不做统计
+*/
+class ParseResult {
+ public:
+  ParseResult(ParseError err = ParseError::PARSE_OK, size_t offset = 0)
+      : err_(err), offset_(offset) {}
+
+  operator ParseError() const { return err_; }
+  ParseError err() const { return err_; }
+  const char *errStr() const { return parseErrorString(err_); }
+  size_t getOffset() const { return offset_; }
+
+  // json须为本次解析的输入 行号和列号均从1开始 列号按字节计
+  size_t getLine(std::string_view json) const {
+    auto prefix = json.substr(0, offset_);
+    return static_cast<size_t>(
+               std::count(prefix.begin(), prefix.end(), '\n')) +
+           1;
+  }
+  size_t getColumn(std::string_view json) const {
+    auto prefix = json.substr(0, offset_);
+    auto newline = prefix.rfind('\n');
+    return newline == std::string_view::npos ? prefix.size() + 1
+                                             : prefix.size() - newline;
+  }
+
+ private:
+  ParseError err_;
+  size_t offset_;
+};
+
 #undef ERROR_MAP
 }  // namespace json
 
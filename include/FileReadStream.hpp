@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <cstdio>
+#include <string_view>
 #include <vector>
 
 #include "noncopyable.hpp"
@@ -37,6 +38,16 @@ class FileReadStream : noncopyable {
     next();
   }
 
+  // 批量访问接口 返回尚未读取的连续字节 配合skip一次跳过多个字节
+  std::string_view getRemaining() const {
+    auto offset = static_cast<size_t>(iter_ - buffer_.cbegin());
+    return std::string_view(buffer_.data() + offset, buffer_.size() - offset);
+  }
+  void skip(size_t n) {
+    assert(n <= static_cast<size_t>(buffer_.cend() - iter_));
+    iter_ += static_cast<std::ptrdiff_t>(n);
+  }
+
  private:
   std::vector<char> buffer_;
   ConstIterator iter_;
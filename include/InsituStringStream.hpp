@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cassert>
+#include <cstring>
+#include <string_view>
+
+#include "noncopyable.hpp"
+
+namespace goa {
+
+namespace json {
+
+/*
+原地解析使用的输入流 接口与StringReadStream一致
+区别在于缓冲区可写：Reader解码含转义的字符串时 直接把结果写回缓冲区
+解码结果总是不长于原文 写指针不会超过读指针
+解析结束后 handler收到的所有字符串都指向这块缓冲区 缓冲区内容被破坏
+*/
+class InsituStringStream : noncopyable {
+ public:
+  using ConstIterator = const char *;
+
+  InsituStringStream(char *json, size_t len)
+      : iter_(json), end_(json + len) {}
+
+  bool hasNext() const { return iter_ != end_; }
+  char peek() const { return hasNext() ? *iter_ : '\0'; }
+  ConstIterator getConstIter() const { return iter_; }
+  char next() { return hasNext() ? *iter_++ : '\0'; }
+  void assertNext(char c) {
+    assert(peek() == c);
+    next();
+  }
+
+  std::string_view getRemaining() const {
+    return std::string_view(iter_, static_cast<size_t>(end_ - iter_));
+  }
+  void skip(size_t n) {
+    assert(n <= static_cast<size_t>(end_ - iter_));
+    iter_ += n;
+  }
+
+  // 当前读位置的可写指针
+  char *getMutableCursor() const { return iter_; }
+
+ private:
+  char *iter_;
+  char *const end_;
+};
+
+}  // namespace json
+
+}  // namespace goa
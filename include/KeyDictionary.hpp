@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace goa {
+
+namespace json {
+
+/*
+预先登记的一组key 解析时Reader在其中查找每个key 把key的编号交给handler
+handler提供以下两个成员时 Reader以KeyId事件代替Key事件:
+  const KeyDictionary &getKeyDictionary() const;
+  bool KeyId(size_t id, std::string_view key);
+id为key登记时的序号 不在字典中的key为kUnknown 重复登记的key取第一次的序号
+handler按id做switch即可 不必再逐个比较字符串
+
+用开放寻址的散列表查找 散列只读取key的长度和首尾各至多8个字节
+构造时依次尝试不同的种子 尽量让登记的key互不冲突 多数查找只需比较一次
+*/
+class KeyDictionary {
+ public:
+  static constexpr size_t kUnknown = static_cast<size_t>(-1);
+
+  KeyDictionary(std::initializer_list<std::string_view> keys)
+      : KeyDictionary(std::vector<std::string>(keys.begin(), keys.end())) {}
+
+  explicit KeyDictionary(std::vector<std::string> keys)
+      : keys_(std::move(keys)) {
+    build();
+  }
+
+  size_t getSize() const { return keys_.size(); }
+  const std::string &getKey(size_t id) const { return keys_[id]; }
+
+  size_t find(std::string_view key) const {
+    for (size_t slot = hash(key, seed_) >> shift_;;
+         slot = (slot + 1) & (slots_.size() - 1)) {
+      uint32_t id = slots_[slot];
+      if (id == kEmpty) return kUnknown;
+      if (keys_[id] == key) return id;
+    }
+  }
+
+ private:
+  static constexpr uint32_t kEmpty = static_cast<uint32_t>(-1);
+  // 每种表长尝试的种子数 以及表长最多为key数的几倍
+  static constexpr uint64_t kSeedsPerSize = 32;
+  static constexpr size_t kMaxSizeFactor = 8;
+
+  static uint64_t hash(std::string_view key, uint64_t seed) {
+    const char *p = key.data();
+    size_t n = key.size();
+    uint64_t a = 0, b = 0;
+    if (n >= 8) {
+      std::memcpy(&a, p, 8);
+      std::memcpy(&b, p + n - 8, 8);
+    } else if (n >= 4) {
+      uint32_t x, y;
+      std::memcpy(&x, p, 4);
+      std::memcpy(&y, p + n - 4, 4);
+      a = x;
+      b = y;
+    } else if (n > 0) {
+      a = static_cast<unsigned char>(p[0]) |
+          static_cast<unsigned char>(p[n / 2]) << 8 |
+          static_cast<unsigned char>(p[n - 1]) << 16;
+    }
+    // 乘法把低位的差异扩散到高位 槽位取最高的若干位
+    uint64_t h = (a ^ n) * seed;
+    return (h ^ b) * seed;
+  }
+
+  // 把key逐个放入表中 返回冲突时多探查的次数
+  size_t fill(size_t size, int shift, uint64_t seed) {
+    slots_.assign(size, kEmpty);
+    size_t probes = 0;
+    for (size_t id = 0; id < keys_.size(); id++) {
+      size_t slot = hash(keys_[id], seed) >> shift;
+      bool duplicate = false;
+      while (slots_[slot] != kEmpty) {
+        if (keys_[slots_[slot]] == keys_[id]) {
+          duplicate = true;
+          break;
+        }
+        slot = (slot + 1) & (size - 1);
+        probes++;
+      }
+      if (!duplicate) slots_[slot] = static_cast<uint32_t>(id);
+    }
+    return probes;
+  }
+
+  // 找到无冲突的种子即停止 否则采用冲突最少的一个
+  void build() {
+    size_t size = 8;
+    int shift = 61;
+    while (size < keys_.size() * 2) {
+      size *= 2;
+      shift--;
+    }
+    size_t bestProbes = static_cast<size_t>(-1), bestSize = size;
+    int bestShift = shift;
+    uint64_t bestSeed = 0;
+    const size_t maxSize = std::max<size_t>(8, keys_.size() * kMaxSizeFactor);
+    for (; size <= maxSize; size *= 2, shift--) {
+      for (uint64_t i = 0; i < kSeedsPerSize; i++) {
+        // 种子须为奇数
+        uint64_t seed = 0x9e3779b97f4a7c15ULL * (2 * i + 1);
+        size_t probes = fill(size, shift, seed);
+        if (probes < bestProbes) {
+          bestProbes = probes;
+          bestSize = size;
+          bestShift = shift;
+          bestSeed = seed;
+        }
+        if (probes == 0) break;
+      }
+      if (bestProbes == 0) break;
+    }
+    shift_ = bestShift;
+    seed_ = bestSeed;
+    fill(bestSize, bestShift, bestSeed);
+  }
+
+  std::vector<std::string> keys_;
+  std::vector<uint32_t> slots_;  // key的编号 长度为2的幂
+  int shift_ = 0;
+  uint64_t seed_ = 0;
+};
+
+// handler是否通过KeyId接收key的编号
+template <typename Handler, typename = void>
+inline constexpr bool hasKeyDictionary = false;
+template <typename Handler>
+inline constexpr bool hasKeyDictionary<
+    Handler, std::void_t<decltype(std::declval<const Handler &>()
+                                      .getKeyDictionary()
+                                      .find(std::string_view()))>> = true;
+
+// 按handler的类型发出Key或KeyId事件
+template <typename Handler>
+bool emitKey(Handler &handler, std::string_view key) {
+  if constexpr (hasKeyDictionary<Handler>)
+    return handler.KeyId(handler.getKeyDictionary().find(key), key);
+  else
+    return handler.Key(key);
+}
+
+}  // namespace json
+
+}  // namespace goa
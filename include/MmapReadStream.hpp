@@ -0,0 +1,91 @@
+#pragma once
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <cassert>
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+#include "noncopyable.hpp"
+
+namespace goa {
+
+namespace json {
+
+/*
+把文件映射到内存后直接在映射的字节上解析 省去FileReadStream读入时的拷贝
+从文件的当前位置读到末尾 与FileReadStream相同 构造后即可关闭文件
+管道、终端等无法映射的输入 退回到用read(2)读入缓冲区
+*/
+class MmapReadStream : noncopyable {
+ public:
+  using ConstIterator = std::string_view::const_iterator;
+
+  explicit MmapReadStream(FILE *input) {
+    int fd = fileno(input);
+    long pos = ftell(input);
+    struct stat st;
+    if (pos >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+        st.st_size > pos) {
+      auto size = static_cast<size_t>(st.st_size);
+      void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED) {
+        madvise(addr, size, MADV_SEQUENTIAL);
+        mapped_ = static_cast<const char *>(addr);
+        mappedSize_ = size;
+        auto offset = static_cast<size_t>(pos);
+        json_ = std::string_view(mapped_ + offset, size - offset);
+      }
+    }
+    if (mapped_ == nullptr) readAll(input);
+    iter_ = json_.begin();
+  }
+
+  ~MmapReadStream() {
+    if (mapped_ != nullptr)
+      munmap(const_cast<char *>(mapped_), mappedSize_);
+  }
+
+  // 输入是否通过映射读取
+  bool isMapped() const { return mapped_ != nullptr; }
+
+  bool hasNext() const { return iter_ != json_.end(); }
+  char peek() const { return hasNext() ? *iter_ : '\0'; }
+  ConstIterator getConstIter() const { return iter_; }
+  char next() { return hasNext() ? *iter_++ : '\0'; }
+  void assertNext(char c) {
+    assert(peek() == c);
+    next();
+  }
+
+  // 批量访问接口 返回尚未读取的连续字节 配合skip一次跳过多个字节
+  std::string_view getRemaining() const {
+    return json_.substr(static_cast<size_t>(iter_ - json_.begin()));
+  }
+  void skip(size_t n) {
+    assert(n <= static_cast<size_t>(json_.end() - iter_));
+    iter_ += n;
+  }
+
+ private:
+  // 经由FILE读取 不丢失FILE中已缓冲的数据 大块读取时stdio直接调用read(2)
+  void readAll(FILE *input) {
+    char buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), input)) > 0)
+      buffer_.insert(buffer_.end(), buf, buf + n);
+    json_ = std::string_view(buffer_.data(), buffer_.size());
+  }
+
+  const char *mapped_ = nullptr;
+  size_t mappedSize_ = 0;
+  std::vector<char> buffer_;
+  std::string_view json_;
+  ConstIterator iter_;
+};
+
+}  // namespace json
+
+}  // namespace goa
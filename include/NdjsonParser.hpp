@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "Document.hpp"
+#include "Exception.hpp"
+#include "Reader.hpp"
+#include "StringReadStream.hpp"
+#include "ThreadPool.hpp"
+
+namespace goa {
+
+namespace json {
+
+/*
+NDJSON(JSON Lines)的并行解析 输入中每行是一个独立的json值
+json字符串里的换行必须转义 所以输入中的'\n'一定是记录的边界 按'\n'切分即可
+只含空白的行被忽略 行尾的'\r'作为空白由Reader跳过
+
+记录按字节数分批 由线程池中的线程和调用线程一起解析
+每条记录解析到各自的handler中 结果按记录在输入中的顺序给出
+一条记录出错不影响其他记录
+*/
+class NdjsonParser : noncopyable {
+ public:
+  explicit NdjsonParser(size_t threads = ThreadPool::defaultThreads())
+      : pool_(threads) {}
+
+  size_t getThreads() const { return pool_.getThreads(); }
+
+  // handlers被重置为与记录数相同的长度 handlers[i]接收第i条记录的事件
+  // 返回每条记录的解析结果 偏移量相对于整个input 可直接用getLine(input)定位
+  template <typename Handler>
+  std::vector<ParseResult> parse(std::string_view input,
+                                 std::vector<Handler> &handlers) {
+    split(input);
+    handlers.clear();
+    handlers.resize(records_.size());
+    std::vector<ParseResult> results(records_.size());
+    forEachBatch([&](size_t i) {
+      StringReadStream is(records_[i]);
+      ParseResult result = Reader::parse(is, handlers[i]);
+      results[i] = ParseResult(result.err(), offsetOf(input, i, result));
+    });
+    return results;
+  }
+
+  // 最近一次parse切分出的记录 与结果一一对应
+  const std::vector<std::string_view> &getRecords() const { return records_; }
+
+ private:
+  // 每批记录的总长度 过小时领取任务的开销变得明显 过大时线程间负载不均
+  static constexpr size_t kBatchBytes = 64 * 1024;
+
+  void split(std::string_view input) {
+    records_.clear();
+    batches_.clear();
+    size_t batchBytes = 0;
+    const char *p = input.data(), *end = p + input.size();
+    while (p != end) {
+      auto *newline = static_cast<const char *>(
+          std::memchr(p, '\n', static_cast<size_t>(end - p)));
+      const char *last = newline ? newline : end;
+      std::string_view line(p, static_cast<size_t>(last - p));
+      if (!isBlank(line)) {
+        if (batchBytes == 0) batches_.push_back(records_.size());
+        records_.push_back(line);
+        batchBytes += line.size();
+        if (batchBytes >= kBatchBytes) batchBytes = 0;
+      }
+      p = newline ? newline + 1 : end;
+    }
+    batches_.push_back(records_.size());
+  }
+
+  // 对每条记录调用f 同一批的记录由同一线程依次处理
+  template <typename F>
+  void forEachBatch(F &&f) {
+    pool_.parallelFor(batches_.size() - 1, [&](size_t b) {
+      for (size_t i = batches_[b]; i < batches_[b + 1]; i++) f(i);
+    });
+  }
+
+  size_t offsetOf(std::string_view input, size_t i,
+                  const ParseResult &result) const {
+    return static_cast<size_t>(records_[i].data() - input.data()) +
+           result.getOffset();
+  }
+
+  static bool isBlank(std::string_view line) {
+    for (char ch : line)
+      if (!simd::scalar::isSpace(ch)) return false;
+    return true;
+  }
+
+  ThreadPool pool_;
+  std::vector<std::string_view> records_;
+  std::vector<size_t> batches_;  // 每批第一条记录的下标 末尾为记录总数
+};
+
+}  // namespace json
+
+}  // namespace goa
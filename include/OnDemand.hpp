@@ -0,0 +1,449 @@
+#pragma once
+
+#include <cassert>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "Exception.hpp"
+#include "Reader.hpp"
+#include "SimdKernels.hpp"
+#include "StringReadStream.hpp"
+#include "StructuralIndex.hpp"
+#include "Value.hpp"
+#include "noncopyable.hpp"
+
+namespace goa {
+
+namespace json {
+
+class OnDemandDocument;
+
+/*
+按需解析的值 只是指向输入中某个值起始位置的游标 本身不做任何解析
+- operator[]在对象/数组中向后扫描 不需要的值用跳过器整体跳过 不解析其内容
+- 标量只在调用getInt64()、getStringView()等取值函数时才解码
+- 不含转义的字符串直接指向输入 含转义的字符串解码后保存在所属文档中
+
+每次查找都从该对象(数组)的开头扫描 多次访问同一对象时可先保存中间的值
+跳过的值只检查括号和引号是否配对 不做完整的格式校验
+查找不到或遇到格式错误时返回的值exists()为false 格式错误由getError()给出
+标量格式错误时getType()为TYPE_NULL 错误同样由getError()给出
+*/
+class OnDemandValue {
+ public:
+  OnDemandValue() = default;
+
+  bool exists() const { return p_ != nullptr; }
+  ParseError getError() const {
+    if (!exists() || *p_ == '{' || *p_ == '[') return err_;
+    return decode().err;
+  }
+
+  ValueType getType() const {
+    assert(exists());
+    switch (*p_) {
+      case 'n':
+        return ValueType::TYPE_NULL;
+      case 't':
+      case 'f':
+        return ValueType::TYPE_BOOL;
+      case '"':
+        return ValueType::TYPE_STRING;
+      case '[':
+        return ValueType::TYPE_ARRAY;
+      case '{':
+        return ValueType::TYPE_OBJECT;
+      default:
+        return decode().type;  // 数字需解码后才能区分类型
+    }
+  }
+  bool isNull() const { return getType() == ValueType::TYPE_NULL; }
+  bool isBool() const { return getType() == ValueType::TYPE_BOOL; }
+  bool isString() const { return getType() == ValueType::TYPE_STRING; }
+  bool isArray() const { return getType() == ValueType::TYPE_ARRAY; }
+  bool isObject() const { return getType() == ValueType::TYPE_OBJECT; }
+
+  // 与Value的取值函数相同 类型不符时由assert检查
+  bool getBool() const {
+    auto scalar = decode();
+    assert(scalar.type == ValueType::TYPE_BOOL);
+    return scalar.b;
+  }
+  int32_t getInt32() const {
+    auto scalar = decode();
+    assert(scalar.type == ValueType::TYPE_INT32);
+    return static_cast<int32_t>(scalar.i64);
+  }
+  int64_t getInt64() const {
+    auto scalar = decode();
+    assert(scalar.type == ValueType::TYPE_INT64 ||
+           scalar.type == ValueType::TYPE_INT32);
+    return scalar.i64;
+  }
+  double getDouble() const {
+    auto scalar = decode();
+    assert(scalar.type == ValueType::TYPE_DOUBLE);
+    return scalar.d;
+  }
+  std::string_view getStringView() const {
+    auto scalar = decode();
+    assert(scalar.type == ValueType::TYPE_STRING);
+    return scalar.s;
+  }
+  std::string getString() const { return std::string(getStringView()); }
+
+  inline OnDemandValue operator[](std::string_view key) const;
+  inline OnDemandValue operator[](size_t index) const;
+
+  // 依次访问数组的元素 或对象的key和value
+  // func返回false时停止 返回遍历中遇到的格式错误
+  template <typename Func>
+  ParseError forEachElement(Func func) const;
+  template <typename Func>
+  ParseError forEachMember(Func func) const;
+
+ private:
+  friend OnDemandDocument;
+
+  OnDemandValue(const OnDemandDocument *doc, const char *p)
+      : doc_(doc), p_(p) {}
+  static OnDemandValue error(ParseError err) {
+    OnDemandValue value;
+    value.err_ = err;
+    return value;
+  }
+
+  struct Scalar {
+    ValueType type = ValueType::TYPE_NULL;
+    bool b = false;
+    int64_t i64 = 0;
+    double d = 0;
+    std::string_view s;
+    ParseError err = ParseError::PARSE_OK;
+  };
+  inline Scalar decode() const;
+
+  // 以下函数中p均指向某个值(或key)的第一个字节 返回该值之后的位置
+  // 输入在值结束前就已耗尽时返回nullptr
+  inline const char *end() const;
+  inline const char *skipWhiteSpace(const char *p) const;
+  inline const char *skipString(const char *p) const;
+  inline const char *skipContainer(const char *p) const;
+  inline const char *skipValue(const char *p) const;
+  static bool isDelimiter(char ch) {
+    switch (ch) {
+      case ' ':
+      case '\t':
+      case '\r':
+      case '\n':
+      case '{':
+      case '}':
+      case '[':
+      case ']':
+      case ':':
+      case ',':
+      case '"':
+        return true;
+      default:
+        return false;
+    }
+  }
+  inline bool keyEquals(const char *begin, const char *keyEnd,
+                        std::string_view key) const;
+
+  const OnDemandDocument *doc_ = nullptr;
+  const char *p_ = nullptr;
+  ParseError err_ = ParseError::PARSE_OK;
+};
+
+/*
+按需解析的文档 只保存输入的string_view 不拷贝输入 也不建立Value树
+输入须比文档及从中得到的OnDemandValue活得久
+根值之后的内容不做检查
+读取含转义的字符串时会把解码结果存入文档 即使通过const的取值函数
+因此同一文档及从中得到的值不能同时在多个线程中读取
+*/
+class OnDemandDocument : noncopyable {
+ public:
+  explicit OnDemandDocument(std::string_view json) : json_(json) {}
+
+  OnDemandValue getRoot() const {
+    OnDemandValue value(this, json_.data());
+    const char *p = value.skipWhiteSpace(json_.data());
+    if (p == json_.data() + json_.size())
+      return OnDemandValue::error(ParseError::PARSE_EXPECT_VALUE);
+    value.p_ = p;
+    return value;
+  }
+
+  OnDemandValue operator[](std::string_view key) const {
+    return getRoot()[key];
+  }
+  OnDemandValue operator[](size_t index) const { return getRoot()[index]; }
+
+ private:
+  friend OnDemandValue;
+
+  // 同一位置的字符串只解码保存一次 反复读取不会使decoded_增长
+  std::string_view saveDecoded(const char *source, std::string_view s) const {
+    auto [it, inserted] = decodedAt_.try_emplace(source);
+    if (inserted) it->second = decoded_.emplace_back(s);
+    return it->second;
+  }
+
+  std::string_view json_;
+  // 含转义的字符串解码后保存于此 deque扩容时不移动已有元素
+  mutable std::deque<std::string> decoded_;
+  // 字符串在json_中的起始位置 -> decoded_中解码后的内容
+  mutable std::unordered_map<const char *, std::string_view> decodedAt_;
+};
+
+inline const char *OnDemandValue::end() const {
+  return doc_->json_.data() + doc_->json_.size();
+}
+
+inline const char *OnDemandValue::skipWhiteSpace(const char *p) const {
+  return simd::kernels().skipWhiteSpace(p, end());
+}
+
+inline const char *OnDemandValue::skipString(const char *p) const {
+  assert(*p == '"');
+  auto scanString = simd::kernels().scanString;
+  const char *last = end();
+  for (p++;;) {
+    p = scanString(p, last);
+    if (p == last) return nullptr;
+    if (*p == '"') return p + 1;
+    // 反斜杠连同被转义的字符一起跳过 控制字符留给解码时报错
+    p += *p == '\\' ? 2 : 1;
+    if (p > last) return nullptr;
+  }
+}
+
+// 以64字节为一块 用与StructuralIndex相同的位运算排除字符串内的括号
+// 块内只需逐个检查字符串外的结构字符 而不必逐字节扫描
+inline const char *OnDemandValue::skipContainer(const char *p) const {
+  assert(*p == '{' || *p == '[');
+  auto classify = simd::kernels().classify;
+  const char *last = end();
+  StringTracker strings;
+  size_t depth = 0;
+  char tail[64];
+
+  for (const char *block = p; block < last; block += 64) {
+    const char *chars = block;
+    if (last - block < 64) {
+      // 末尾不足64字节的部分 以空白补齐
+      std::memset(tail, ' ', sizeof(tail));
+      std::memcpy(tail, block, static_cast<size_t>(last - block));
+      chars = tail;
+    }
+    auto masks = classify(chars);
+    uint64_t ops = masks.op & ~strings.next(masks).inString;
+    while (ops != 0) {
+      int i = __builtin_ctzll(ops);
+      switch (chars[i]) {
+        case '{':
+        case '[':
+          depth++;
+          break;
+        case '}':
+        case ']':
+          if (--depth == 0) return block + i + 1;
+          break;
+        default:
+          break;
+      }
+      ops &= ops - 1;
+    }
+  }
+  return nullptr;
+}
+
+inline const char *OnDemandValue::skipValue(const char *p) const {
+  switch (*p) {
+    case '"':
+      return skipString(p);
+    case '{':
+    case '[':
+      return skipContainer(p);
+    default: {
+      // 标量延伸到下一个空白或结构字符为止
+      const char *last = end();
+      while (p != last && !isDelimiter(*p)) p++;
+      return p;
+    }
+  }
+}
+
+inline bool OnDemandValue::keyEquals(const char *begin, const char *keyEnd,
+                                     std::string_view key) const {
+  // [begin, keyEnd)为包括引号在内的key原文
+  std::string_view raw(begin + 1, static_cast<size_t>(keyEnd - begin - 2));
+  if (raw.find('\\') == std::string_view::npos) return raw == key;
+  OnDemandValue value(doc_, begin);
+  auto scalar = value.decode();
+  return scalar.type == ValueType::TYPE_STRING && scalar.s == key;
+}
+
+inline OnDemandValue OnDemandValue::operator[](std::string_view key) const {
+  if (!exists()) return *this;
+  if (*p_ != '{') return OnDemandValue();
+
+  const char *last = end();
+  const char *p = skipWhiteSpace(p_ + 1);
+  if (p != last && *p == '}') return OnDemandValue();
+  while (true) {
+    if (p == last || *p != '"') return error(ParseError::PARSE_MISS_KEY);
+    const char *keyEnd = skipString(p);
+    if (keyEnd == nullptr)
+      return error(ParseError::PARSE_MISS_QUOTATION_MARK);
+    bool found = keyEquals(p, keyEnd, key);
+
+    p = skipWhiteSpace(keyEnd);
+    if (p == last || *p != ':') return error(ParseError::PARSE_MISS_COLON);
+    p = skipWhiteSpace(p + 1);
+    if (p == last) return error(ParseError::PARSE_EXPECT_VALUE);
+    if (found) return OnDemandValue(doc_, p);
+
+    p = skipValue(p);
+    if (p != nullptr) p = skipWhiteSpace(p);
+    if (p == nullptr || p == last || (*p != ',' && *p != '}'))
+      return error(ParseError::PARSE_MISS_COMMA_OR_CURLY_BRACKET);
+    if (*p == '}') return OnDemandValue();
+    p = skipWhiteSpace(p + 1);
+  }
+}
+
+inline OnDemandValue OnDemandValue::operator[](size_t index) const {
+  OnDemandValue found;
+  ParseError err = forEachElement([&](OnDemandValue value) {
+    if (index-- != 0) return true;
+    found = value;
+    return false;
+  });
+  return err == ParseError::PARSE_OK ? found : error(err);
+}
+
+template <typename Func>
+ParseError OnDemandValue::forEachElement(Func func) const {
+  if (!exists()) return err_;
+  if (*p_ != '[') return ParseError::PARSE_OK;
+
+  const char *last = end();
+  const char *p = skipWhiteSpace(p_ + 1);
+  if (p != last && *p == ']') return ParseError::PARSE_OK;
+  while (true) {
+    if (p == last) return ParseError::PARSE_EXPECT_VALUE;
+    if (!func(OnDemandValue(doc_, p))) return ParseError::PARSE_OK;
+
+    p = skipValue(p);
+    if (p != nullptr) p = skipWhiteSpace(p);
+    if (p == nullptr || p == last || (*p != ',' && *p != ']'))
+      return ParseError::PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+    if (*p == ']') return ParseError::PARSE_OK;
+    p = skipWhiteSpace(p + 1);
+  }
+}
+
+template <typename Func>
+ParseError OnDemandValue::forEachMember(Func func) const {
+  if (!exists()) return err_;
+  if (*p_ != '{') return ParseError::PARSE_OK;
+
+  const char *last = end();
+  const char *p = skipWhiteSpace(p_ + 1);
+  if (p != last && *p == '}') return ParseError::PARSE_OK;
+  while (true) {
+    if (p == last || *p != '"') return ParseError::PARSE_MISS_KEY;
+    auto key = OnDemandValue(doc_, p).decode();
+    if (key.err != ParseError::PARSE_OK) return key.err;
+    p = skipWhiteSpace(skipString(p));
+    if (p == last || *p != ':') return ParseError::PARSE_MISS_COLON;
+    p = skipWhiteSpace(p + 1);
+    if (p == last) return ParseError::PARSE_EXPECT_VALUE;
+    if (!func(key.s, OnDemandValue(doc_, p))) return ParseError::PARSE_OK;
+
+    p = skipValue(p);
+    if (p != nullptr) p = skipWhiteSpace(p);
+    if (p == nullptr || p == last || (*p != ',' && *p != '}'))
+      return ParseError::PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+    if (*p == '}') return ParseError::PARSE_OK;
+    p = skipWhiteSpace(p + 1);
+  }
+}
+
+// 复用Reader对标量的解析 保证与Document得到的值完全一致
+inline OnDemandValue::Scalar OnDemandValue::decode() const {
+  class Capture : noncopyable {
+   public:
+    Capture(Scalar &scalar, const OnDemandDocument &doc, const char *source)
+        : scalar_(scalar), doc_(doc), source_(source) {}
+
+    bool Null() { return set(ValueType::TYPE_NULL); }
+    bool Bool(bool b) {
+      scalar_.b = b;
+      return set(ValueType::TYPE_BOOL);
+    }
+    bool Int32(int32_t i32) {
+      scalar_.i64 = i32;
+      return set(ValueType::TYPE_INT32);
+    }
+    bool Int64(int64_t i64) {
+      scalar_.i64 = i64;
+      return set(ValueType::TYPE_INT64);
+    }
+    bool Double(double d) {
+      scalar_.d = d;
+      return set(ValueType::TYPE_DOUBLE);
+    }
+    bool String(std::string_view s) {
+      // 含转义的字符串由Reader解码到临时缓冲区 需转存到文档中
+      auto json = doc_.json_;
+      if (s.data() < json.data() || s.data() + s.size() > json.end())
+        s = doc_.saveDecoded(source_, s);
+      scalar_.s = s;
+      return set(ValueType::TYPE_STRING);
+    }
+    bool Key(std::string_view) { return false; }
+    bool StartObject() { return false; }
+    bool EndObject() { return false; }
+    bool StartArray() { return false; }
+    bool EndArray() { return false; }
+
+   private:
+    bool set(ValueType type) {
+      scalar_.type = type;
+      return true;
+    }
+
+    Scalar &scalar_;
+    const OnDemandDocument &doc_;
+    const char *source_;
+  };
+
+  assert(exists());
+  Scalar scalar;
+  // 已解码过的转义字符串 直接取保存的结果 其他标量不会在其中
+  if (*p_ == '"') {
+    auto decoded = doc_->decodedAt_.find(p_);
+    if (decoded != doc_->decodedAt_.end()) {
+      scalar.type = ValueType::TYPE_STRING;
+      scalar.s = decoded->second;
+      return scalar;
+    }
+  }
+  Capture capture(scalar, *doc_, p_);
+  StringReadStream is(
+      std::string_view(p_, static_cast<size_t>(end() - p_)));
+  scalar.err = Reader::parseScalar(is, capture);
+  if (scalar.err != ParseError::PARSE_OK) scalar.type = ValueType::TYPE_NULL;
+  return scalar;
+}
+
+}  // namespace json
+
+}  // namespace goa
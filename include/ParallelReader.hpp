@@ -0,0 +1,291 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "Document.hpp"
+#include "Exception.hpp"
+#include "Reader.hpp"
+#include "SimdKernels.hpp"
+#include "StringReadStream.hpp"
+#include "StructuralIndex.hpp"
+#include "ThreadPool.hpp"
+
+namespace goa {
+
+namespace json {
+
+/*
+顶层为一个大数组(或对象)时的并行解析
+1. 用SIMD按64字节块扫描一遍 只跟踪括号深度和字符串区间 记下顶层的逗号和冒号
+   由此把容器切分成各个元素(成员) 这一步不检查其余语法
+2. 元素按字节数分批 由线程池并行地各自用Reader解析 每个元素得到一个Value
+3. 按原来的顺序拼成一个数组(对象) 或依次发给handler
+
+切分只依赖括号和引号 格式错误的输入可能被切错 但每个元素都要被Reader完整解析
+所有元素都解析成功时 整个输入必然合法且结果与Reader相同
+有任何元素失败时 再用Reader::validate顺序检查一遍 得到与Reader相同的错误码和位置
+不是容器、只有一个线程或切分后只有一批时 直接交给Reader
+
+目标Document的引用计数方式沿用到所有节点
+目标Document指定了resource时 所有节点都须从它分配 而内存池(如
+monotonic_buffer_resource)不是线程安全的 因此也直接交给Document::parse
+*/
+class ParallelReader : noncopyable {
+ public:
+  explicit ParallelReader(size_t threads = ThreadPool::defaultThreads())
+      : pool_(threads) {}
+
+  size_t getThreads() const { return pool_.getThreads(); }
+
+  // doc须为新建的Document
+  ParseResult parse(std::string_view json, Document &doc) {
+    if (doc.getMemoryResource() != nullptr || !splitForThreads(json))
+      return doc.parse(json);
+    policy_ = doc.getRefCountPolicy();
+
+    std::vector<Value> keys, values;
+    if (!parseBatches(0, batches_.size() - 1, keys, values)) {
+      ParseResult result = validate(json);
+      if (result == ParseError::PARSE_OK) return doc.parse(json);
+      return result;
+    }
+    // 拼接时只移动Value 不拷贝其内容
+    Value &root = doc;
+    root = Value(object_ ? ValueType::TYPE_OBJECT : ValueType::TYPE_ARRAY,
+                 nullptr, policy_);
+    if (object_) {
+      for (size_t i = 0; i < values.size(); i++)
+        root.addMember(std::move(keys[i]), std::move(values[i]));
+    } else {
+      for (auto &value : values) root.addValue(std::move(value));
+    }
+    return ParseResult(ParseError::PARSE_OK, json.size());
+  }
+
+// handler中止时 偏移量为当前元素的起始位置
+#define CALL(expr, offset) \
+  if (!(expr))             \
+  return ParseResult(ParseError::PARSE_USER_STOPPED, offset)
+
+  // 各批并行解析后 在调用线程上按顺序把事件发给handler 因此handler无需线程安全
+  // 每次只解析若干批 解析出的Value发送后即释放 内存占用与输入大小无关
+  // 出错时错误码和位置与Reader相同 但handler可能只收到部分事件
+  template <typename Handler>
+  ParseResult parse(std::string_view json, Handler &handler) {
+    if (!splitForThreads(json)) {
+      StringReadStream is(json);
+      return Reader::parse(is, handler);
+    }
+    policy_ = RefCountPolicy::ATOMIC;
+
+    const size_t numBatches = batches_.size() - 1;
+    const size_t wave = getThreads() * kBatchesPerThread;
+    std::vector<Value> keys, values;
+    // 第一轮在发出任何事件之前解析 失败而整体合法时仍可交给Reader重新解析
+    size_t lastBatch = std::min(wave, numBatches);
+    if (!parseBatches(0, lastBatch, keys, values)) {
+      ParseResult result = validate(json);
+      if (result != ParseError::PARSE_OK) return result;
+      StringReadStream is(json);
+      return Reader::parse(is, handler);
+    }
+
+    if (object_) {
+      CALL(handler.StartObject(), 0);
+    } else {
+      CALL(handler.StartArray(), 0);
+    }
+    for (size_t b = 0; b < numBatches;
+         b = lastBatch, lastBatch = std::min(b + wave, numBatches)) {
+      const Range *range = &ranges_[batches_[b]];
+      if (b > 0 && !parseBatches(b, lastBatch, keys, values)) {
+        // 事件已发出一部分 不能再重来 整体合法时也不能返回PARSE_OK
+        ParseResult result = validate(json);
+        if (result != ParseError::PARSE_OK) return result;
+        return ParseResult(ParseError::PARSE_BAD_VALUE,
+                           static_cast<size_t>(range->begin - json.data()));
+      }
+
+      for (size_t i = 0; i < values.size(); i++, range++) {
+        auto offset = static_cast<size_t>(range->begin - json.data());
+        if (object_) CALL(emitKey(handler, keys[i].getStringView()), offset);
+        CALL(values[i].writeTo(handler), offset);
+      }
+    }
+    if (object_) {
+      CALL(handler.EndObject(), json.size());
+    } else {
+      CALL(handler.EndArray(), json.size());
+    }
+    return ParseResult(ParseError::PARSE_OK, json.size());
+  }
+
+#undef CALL
+
+ private:
+  // 每批元素的总长度 过小时领取任务的开销变得明显 过大时线程间负载不均
+  static constexpr size_t kBatchBytes = 64 * 1024;
+  // 向handler发送事件时 每轮解析的批数为线程数的若干倍
+  static constexpr size_t kBatchesPerThread = 4;
+
+  // 顶层容器中的一个元素 [begin, end)不含两侧的逗号或括号
+  // 对象成员的key在[begin, colon)中 值在(colon, end)中
+  struct Range {
+    const char *begin;
+    const char *colon;
+    const char *end;
+  };
+
+  // 只有一个线程或只有一批时 并行没有收益
+  bool splitForThreads(std::string_view json) {
+    return getThreads() > 1 && split(json) && batches_.size() > 2;
+  }
+
+  // 划分顶层容器 无法划分(不是容器 或括号不配对等)时返回false
+  bool split(std::string_view json) {
+    ranges_.clear();
+    batches_.clear();
+    const char *p = json.data(), *last = p + json.size();
+    while (p != last && simd::scalar::isSpace(*p)) p++;
+    if (p == last || (*p != '[' && *p != '{')) return false;
+    object_ = *p == '{';
+
+    const char *close = findRanges(p, last);
+    if (close == nullptr || *close != (object_ ? '}' : ']')) return false;
+    for (p = close + 1; p != last; p++)
+      if (!simd::scalar::isSpace(*p)) return false;
+
+    // 空容器的唯一一段只含空白 其余情况下空白的元素由Reader报错
+    if (ranges_.size() == 1 && isBlank(ranges_[0])) ranges_.clear();
+    size_t batchBytes = 0;
+    for (size_t i = 0; i < ranges_.size(); i++) {
+      if (object_ && ranges_[i].colon == nullptr) return false;
+      if (batchBytes == 0) batches_.push_back(i);
+      batchBytes += static_cast<size_t>(ranges_[i].end - ranges_[i].begin);
+      if (batchBytes >= kBatchBytes) batchBytes = 0;
+    }
+    batches_.push_back(ranges_.size());
+    return true;
+  }
+
+  // p指向顶层的左括号 返回与之配对的右括号 没有时返回nullptr
+  const char *findRanges(const char *p, const char *last) {
+    auto classify = simd::kernels().classify;
+    StringTracker strings;
+    size_t depth = 0;
+    Range range{p + 1, nullptr, nullptr};
+    char tail[64];
+
+    for (const char *block = p; block < last; block += 64) {
+      const char *chars = block;
+      if (last - block < 64) {
+        // 末尾不足64字节的部分 以空白补齐
+        std::memset(tail, ' ', sizeof(tail));
+        std::memcpy(tail, block, static_cast<size_t>(last - block));
+        chars = tail;
+      }
+      auto masks = classify(chars);
+      uint64_t ops = masks.op & ~strings.next(masks).inString;
+      while (ops != 0) {
+        int i = __builtin_ctzll(ops);
+        ops &= ops - 1;
+        switch (chars[i]) {
+          case '{':
+          case '[':
+            depth++;
+            break;
+          case '}':
+          case ']':
+            if (--depth == 0) {
+              range.end = block + i;
+              ranges_.push_back(range);
+              return block + i;
+            }
+            break;
+          case ',':
+            if (depth == 1) {
+              range.end = block + i;
+              ranges_.push_back(range);
+              range = Range{block + i + 1, nullptr, nullptr};
+            }
+            break;
+          case ':':
+            if (depth == 1 && range.colon == nullptr) range.colon = block + i;
+            break;
+        }
+      }
+    }
+    return nullptr;
+  }
+
+  // 并行解析第[firstBatch, lastBatch)批 结果按顺序存入keys和values
+  // 有元素解析失败时返回false
+  bool parseBatches(size_t firstBatch, size_t lastBatch,
+                    std::vector<Value> &keys, std::vector<Value> &values) {
+    const size_t first = batches_[firstBatch];
+    const size_t n = batches_[lastBatch] - first;
+    keys.assign(object_ ? n : 0, Value());
+    values.assign(n, Value());
+    std::atomic<bool> failed{false};
+    pool_.parallelFor(lastBatch - firstBatch, [&](size_t b) {
+      // 元素位于顶层容器之内 可用的嵌套层数比Reader少一层
+      ParseStack stack(ParseStack::kDefaultMaxDepth - 1);
+      b += firstBatch;
+      for (size_t i = batches_[b]; i < batches_[b + 1]; i++) {
+        if (failed.load(std::memory_order_relaxed)) return;
+        Value *key = object_ ? &keys[i - first] : nullptr;
+        if (!parseRange(ranges_[i], stack, key, values[i - first]))
+          failed.store(true, std::memory_order_relaxed);
+      }
+    });
+    return !failed.load();
+  }
+
+  bool parseRange(const Range &range, ParseStack &stack, Value *key,
+                  Value &value) {
+    const char *valueBegin = range.begin;
+    if (key != nullptr) {
+      Document doc(policy_);
+      if (!parseText(range.begin, range.colon, stack, doc) || !doc.isString())
+        return false;
+      *key = std::move(doc);
+      valueBegin = range.colon + 1;
+    }
+    Document doc(policy_);
+    if (!parseText(valueBegin, range.end, stack, doc)) return false;
+    value = std::move(doc);
+    return true;
+  }
+
+  static bool parseText(const char *begin, const char *end, ParseStack &stack,
+                        Document &doc) {
+    std::string_view text(begin, static_cast<size_t>(end - begin));
+    StringReadStream is(text);
+    return Reader::parse(is, doc, stack) == ParseError::PARSE_OK;
+  }
+
+  static ParseResult validate(std::string_view json) {
+    StringReadStream is(json);
+    return Reader::validate(is);
+  }
+
+  static bool isBlank(const Range &range) {
+    for (const char *p = range.begin; p != range.end; p++)
+      if (!simd::scalar::isSpace(*p)) return false;
+    return true;
+  }
+
+  ThreadPool pool_;
+  bool object_ = false;
+  RefCountPolicy policy_ = RefCountPolicy::ATOMIC;  // 各元素节点的引用计数方式
+  std::vector<Range> ranges_;
+  std::vector<size_t> batches_;  // 每批第一个元素的下标 末尾为元素总数
+};
+
+}  // namespace json
+
+}  // namespace goa
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cassert>
+#include <charconv>
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace goa {
+
+namespace json {
+
+/*
+一组JSON Pointer(RFC 6901)路径 用于在解析时只保留其中的部分 如"/data/total"
+路径中某一层为"*"时 匹配对象的任意key或数组的任意下标
+数组下标用十进制数表示 "~1"和"~0"分别转义"/"和"~" 空路径""表示整个文档
+
+路径组织成前缀树 每个节点对应路径上的一层:
+- terminal节点: 此处的值整个保留
+- 其余节点: 只保留能通往terminal节点的成员或元素 其他的一律跳过
+添加路径时把"*"子树合并进同层的每个具体key 使匹配时每层只需查找一个节点
+*/
+class PathFilter {
+ public:
+  static constexpr size_t kNone = static_cast<size_t>(-1);
+
+  PathFilter() : nodes_(1) {}
+  PathFilter(std::initializer_list<std::string_view> pointers) : PathFilter() {
+    for (auto pointer : pointers) add(pointer);
+  }
+
+  // 路径格式错误(非空且不以'/'开头 或含非法的'~'转义)时返回false
+  bool add(std::string_view pointer) {
+    std::vector<std::string> tokens;
+    if (!split(pointer, tokens)) return false;
+    size_t node = 0;
+    for (auto &token : tokens) node = addChild(node, token);
+    nodes_[node].terminal = true;
+    resolveWildcards(0);
+    return true;
+  }
+
+  // 以下供Reader在解析时使用 节点以下标表示 0为根节点
+  static constexpr size_t root() { return 0; }
+  bool isTerminal(size_t node) const { return nodes_[node].terminal; }
+  bool hasChildren(size_t node) const {
+    return !nodes_[node].children.empty() || nodes_[node].wildcard != kNone;
+  }
+  // 不匹配时返回kNone
+  size_t findChild(size_t node, std::string_view key) const {
+    for (auto &[name, child] : nodes_[node].children)
+      if (name == key) return child;
+    return nodes_[node].wildcard;
+  }
+  // 大数组的每个元素都会调用 没有具体下标时不必格式化
+  size_t findChild(size_t node, size_t index) const {
+    if (nodes_[node].children.empty()) return nodes_[node].wildcard;
+    char buf[24];
+    auto end = std::to_chars(buf, buf + sizeof buf, index).ptr;
+    return findChild(node,
+                     std::string_view(buf, static_cast<size_t>(end - buf)));
+  }
+
+ private:
+  struct Node {
+    bool terminal = false;
+    size_t wildcard = kNone;
+    std::vector<std::pair<std::string, size_t>> children;
+  };
+
+  static bool split(std::string_view pointer, std::vector<std::string> &out) {
+    if (pointer.empty()) return true;
+    if (pointer[0] != '/') return false;
+    for (size_t i = 0; i < pointer.size();) {
+      std::string token;
+      for (i++; i < pointer.size() && pointer[i] != '/'; i++) {
+        if (pointer[i] != '~') {
+          token += pointer[i];
+        } else if (i + 1 < pointer.size() &&
+                   (pointer[i + 1] == '0' || pointer[i + 1] == '1')) {
+          token += pointer[++i] == '0' ? '~' : '/';
+        } else {
+          return false;
+        }
+      }
+      out.push_back(std::move(token));
+    }
+    return true;
+  }
+
+  size_t addChild(size_t node, const std::string &token) {
+    if (token == "*") {
+      if (nodes_[node].wildcard == kNone) {
+        nodes_[node].wildcard = nodes_.size();
+        nodes_.emplace_back();
+      }
+      return nodes_[node].wildcard;
+    }
+    for (auto &[name, child] : nodes_[node].children)
+      if (name == token) return child;
+    size_t child = nodes_.size();
+    nodes_.emplace_back();
+    nodes_[node].children.emplace_back(token, child);
+    return child;
+  }
+
+  // 把src子树并入dst 合并是幂等的 重复合并不会改变结果
+  void merge(size_t dst, size_t src) {
+    if (dst == src) return;
+    if (nodes_[src].terminal) nodes_[dst].terminal = true;
+    for (size_t i = 0; i < nodes_[src].children.size(); i++) {
+      // 递归中nodes_可能扩容 不能持有元素的引用
+      auto [name, child] = nodes_[src].children[i];
+      merge(addChild(dst, name), child);
+    }
+    if (nodes_[src].wildcard != kNone)
+      merge(addChild(dst, "*"), nodes_[src].wildcard);
+  }
+
+  // 让每个具体key也匹配同层"*"之后的路径
+  void resolveWildcards(size_t node) {
+    size_t wildcard = nodes_[node].wildcard;
+    for (size_t i = 0; i < nodes_[node].children.size(); i++) {
+      size_t child = nodes_[node].children[i].second;
+      if (wildcard != kNone) merge(child, wildcard);
+      resolveWildcards(child);
+    }
+    if (wildcard != kNone) resolveWildcards(wildcard);
+  }
+
+  std::vector<Node> nodes_;
+};
+
+}  // namespace json
+
+}  // namespace goa
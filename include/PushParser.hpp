@@ -0,0 +1,301 @@
+#pragma once
+
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Exception.hpp"
+#include "Reader.hpp"
+#include "SimdKernels.hpp"
+#include "StringReadStream.hpp"
+
+namespace goa {
+
+namespace json {
+
+// 单次feed/resume可用的工作量 任一项用尽即暂停 默认不限
+// 只在token之间检查 单个很长的字符串仍会一次解析完
+struct ParseBudget {
+  size_t bytes = std::numeric_limits<size_t>::max();
+  std::chrono::nanoseconds time = std::chrono::nanoseconds::max();
+};
+
+/*
+推式解析器 输入可分多次通过feed送入 如从socket陆续读到的数据
+与Reader发送相同的事件和错误码 错误的偏移量从第一次feed的开头算起
+
+解析以token为单位推进:
+- 结构字符和空白读到即处理
+- 字符串要等到右引号 数字和字面量要等到其后的分隔符出现在缓冲区中
+  才交给Reader解析 因此不会有半个token被解析 不完整的部分留到下次feed
+- 已扫描过的未完成部分会记录下来 下次只扫描新到的数据
+
+handler收到的string_view只在回调期间有效
+输入结束后调用finish 检查文档是否完整 以及顶层的数字等只能在结尾确定的值
+Flags为ParseFlag的组合 与Reader::parse的相同
+*/
+template <typename Handler, unsigned Flags = kParseDefaultFlags>
+class PushParser : noncopyable {
+ public:
+  explicit PushParser(Handler &handler,
+                      size_t maxDepth = ParseStack::kDefaultMaxDepth)
+      : handler_(handler), maxDepth_(maxDepth) {}
+
+  // 返回PARSE_OK表示目前为止的输入没有错误 偏移量为已处理的字节数
+  // 出错后不再解析 之后的调用都返回同一个错误
+  ParseResult feed(std::string_view chunk,
+                   const ParseBudget &budget = ParseBudget()) {
+    assert(!finished_ && "feed after finish");
+    if (error_ != ParseError::PARSE_OK) return getResult();
+    if (begin_ == buffer_.size()) {
+      // 没有遗留的数据时直接解析chunk 只拷贝剩下的部分
+      buffer_.clear();
+      begin_ = 0;
+      size_t n = run(chunk, budget);
+      buffer_.assign(chunk.substr(n));
+    } else {
+      buffer_.append(chunk);
+      begin_ += run(std::string_view(buffer_).substr(begin_), budget);
+      // 已处理的部分过半时才移动数据 使拷贝的总量与输入成线性
+      if (begin_ * 2 >= buffer_.size()) {
+        buffer_.erase(0, begin_);
+        begin_ = 0;
+      }
+    }
+    return getResult();
+  }
+
+  // 因预算用尽而暂停后 继续解析已缓冲的数据
+  ParseResult resume(const ParseBudget &budget = ParseBudget()) {
+    return feed(std::string_view(), budget);
+  }
+
+  // 输入结束 解析剩余的全部数据
+  ParseResult finish() {
+    assert(!finished_ && "finish twice");
+    finished_ = true;
+    if (error_ == ParseError::PARSE_OK)
+      run(std::string_view(buffer_).substr(begin_), ParseBudget());
+    buffer_.clear();
+    begin_ = 0;
+    return getResult();
+  }
+
+  // 上一次feed/resume因预算用尽而返回 缓冲区中还有可解析的数据
+  bool isPaused() const { return paused_; }
+
+  ParseResult getResult() const { return ParseResult(error_, offset_); }
+
+ private:
+#define CALL(expr) \
+  if (!(expr)) return ParseError::PARSE_USER_STOPPED
+#define TRY(expr)                                          \
+  do {                                                     \
+    ParseError err_ = (expr);                              \
+    if (__builtin_expect(err_ != ParseError::PARSE_OK, 0)) \
+      return err_;                                         \
+  } while (0)
+
+  // ARRAY_BEGIN和OBJECT_BEGIN: 已读入左括号 下一个非空白字符决定容器是否为空
+  enum class State {
+    VALUE,
+    ARRAY_BEGIN,
+    OBJECT_BEGIN,
+    OBJECT_KEY,
+    COLON,
+    AFTER_VALUE
+  };
+
+  // 返回已处理完的字节数 其后的数据需保留到下次
+  size_t run(std::string_view input, const ParseBudget &budget) {
+    StringReadStream is(input);
+    size_t done = 0;
+    paused_ = false;
+    ParseError err = parse(is, budget, done);
+    if (err != ParseError::PARSE_OK) {
+      error_ = err;
+      offset_ += static_cast<size_t>(is.getConstIter() - input.begin());
+      return input.size();
+    }
+    offset_ += done;
+    return done;
+  }
+
+  ParseError parse(StringReadStream &is, const ParseBudget &budget,
+                   size_t &done) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = is.getConstIter();
+    const bool timed = budget.time != std::chrono::nanoseconds::max();
+    const auto deadline = timed ? Clock::now() + budget.time : Clock::now();
+    size_t steps = 0;
+
+    while (true) {
+      Reader::parseWhiteSpace(is);
+      done = static_cast<size_t>(is.getConstIter() - start);
+      if (!is.hasNext() && !finished_) return ParseError::PARSE_OK;
+      // 至少前进一个token 读时钟的开销较大 每64个token才检查一次
+      if (steps++ > 0 &&
+          (done >= budget.bytes ||
+           (timed && steps % 64 == 0 && Clock::now() >= deadline))) {
+        paused_ = true;
+        return ParseError::PARSE_OK;
+      }
+
+      switch (state_) {
+        case State::VALUE:
+          if (!is.hasNext()) return ParseError::PARSE_EXPECT_VALUE;
+          switch (is.peek()) {
+            case '[':
+              if (levels_.size() >= maxDepth_)
+                return ParseError::PARSE_DEPTH_EXCEEDED;
+              CALL(handler_.StartArray());
+              is.next();
+              state_ = State::ARRAY_BEGIN;
+              break;
+            case '{':
+              if (levels_.size() >= maxDepth_)
+                return ParseError::PARSE_DEPTH_EXCEEDED;
+              CALL(handler_.StartObject());
+              is.next();
+              state_ = State::OBJECT_BEGIN;
+              break;
+            default:
+              if (!finished_ && !isComplete(is.getRemaining()))
+                return ParseError::PARSE_OK;
+              TRY(Reader::parseScalar<Flags>(is, handler_));
+              pending_ = 0;
+              state_ = State::AFTER_VALUE;
+              break;
+          }
+          break;
+
+        case State::ARRAY_BEGIN:
+          if (is.peek() == ']') {
+            is.next();
+            CALL(handler_.EndArray());
+            state_ = State::AFTER_VALUE;
+          } else {
+            levels_.push_back(ValueType::TYPE_ARRAY);
+            state_ = State::VALUE;
+          }
+          break;
+
+        case State::OBJECT_BEGIN:
+          if (is.peek() == '}') {
+            is.next();
+            CALL(handler_.EndObject());
+            state_ = State::AFTER_VALUE;
+          } else {
+            levels_.push_back(ValueType::TYPE_OBJECT);
+            state_ = State::OBJECT_KEY;
+          }
+          break;
+
+        case State::OBJECT_KEY:
+          if (is.peek() != '"') return ParseError::PARSE_MISS_KEY;
+          if (!finished_ && !isComplete(is.getRemaining()))
+            return ParseError::PARSE_OK;
+          TRY(Reader::parseString<Flags>(is, handler_, true));
+          pending_ = 0;
+          state_ = State::COLON;
+          break;
+
+        case State::COLON:
+          if (is.peek() != ':') return ParseError::PARSE_MISS_COLON;
+          is.next();
+          state_ = State::VALUE;
+          break;
+
+        case State::AFTER_VALUE:
+          if (levels_.empty()) {
+            // 只有输入结束时才会在这里遇到空的剩余数据
+            if (is.hasNext()) return ParseError::PARSE_ROOT_NOT_SINGULAR;
+            return ParseError::PARSE_OK;
+          }
+          if (levels_.back() == ValueType::TYPE_ARRAY) {
+            switch (is.peek()) {
+              case ',':
+                is.next();
+                state_ = State::VALUE;
+                break;
+              case ']':
+                is.next();
+                levels_.pop_back();
+                CALL(handler_.EndArray());
+                break;
+              default:
+                return ParseError::PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+            }
+          } else {
+            switch (is.peek()) {
+              case ',':
+                is.next();
+                state_ = State::OBJECT_KEY;
+                break;
+              case '}':
+                is.next();
+                levels_.pop_back();
+                CALL(handler_.EndObject());
+                break;
+              default:
+                return ParseError::PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+            }
+          }
+          break;
+      }
+    }
+  }
+
+#undef TRY
+#undef CALL
+
+  // rest以一个标量开头 判断它是否已完整地在缓冲区中
+  // 字符串以未转义的右引号结束 遇到控制字符时Reader会直接报错 也视为完整
+  // 数字和字面量以第一个不可能属于它的字符结束
+  // 已确认尚未结束的长度记在pending_中 下次从那里继续扫描
+  bool isComplete(std::string_view rest) {
+    const char *begin = rest.data(), *end = begin + rest.size();
+    const char *p = begin + pending_;
+    if (*begin == '"') {
+      if (p == begin) p++;
+      while ((p = simd::kernels().scanString(p, end)) != end) {
+        if (*p != '\\') return true;
+        if (end - p < 2) break;
+        p += 2;
+      }
+    } else {
+      while (p != end && isWordChar(*p)) p++;
+      if (p != end) return true;
+    }
+    pending_ = static_cast<size_t>(p - begin);
+    return false;
+  }
+
+  // 数字(含i32/i64后缀)和true/false/null/NaN/Infinity可能包含的字符
+  static bool isWordChar(char ch) {
+    return (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'z') ||
+           (ch >= 'A' && ch <= 'Z') || ch == '+' || ch == '-' || ch == '.';
+  }
+
+  Handler &handler_;
+  std::vector<ValueType> levels_;
+  size_t maxDepth_;
+  State state_ = State::VALUE;
+
+  std::string buffer_;  // 未处理完的输入 从begin_开始
+  size_t begin_ = 0;
+  size_t pending_ = 0;  // 缓冲区开头的不完整标量已扫描过的长度
+
+  ParseError error_ = ParseError::PARSE_OK;
+  size_t offset_ = 0;  // 已处理的字节数 出错时为出错位置
+  bool paused_ = false;
+  bool finished_ = false;
+};
+
+}  // namespace json
+
+}  // namespace goa
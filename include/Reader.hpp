@@ -1,12 +1,24 @@
 
 #pragma once
+#include <charconv>
 #include <cmath>
-#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <string>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "AsyncFileReadStream.hpp"
+#include "BufferedFileReadStream.hpp"
 #include "Exception.hpp"
 #include "FileReadStream.hpp"
+#include "MmapReadStream.hpp"
+#include "InsituStringStream.hpp"
+#include "KeyDictionary.hpp"
+#include "PathFilter.hpp"
+#include "SimdKernels.hpp"
 #include "StringReadStream.hpp"
 #include "Value.hpp"
 
@@ -14,47 +26,227 @@ namespace goa {
 
 namespace json {
 
+class OnDemandValue;
+class Reader;
+class StructuralReader;
+template <typename Handler, unsigned Flags>
+class PushParser;
+
+// 读完缓冲区后会重新填充的输入流 已读取的数据随时可能被丢弃
+template <typename ReadStream>
+inline constexpr bool isRefillable =
+    std::is_same_v<ReadStream, BufferedFileReadStream> ||
+    std::is_same_v<ReadStream, AsyncFileReadStream>;
+
+// Reader可接受的输入流类型
+template <typename ReadStream>
+inline constexpr bool isReadStream =
+    std::is_same_v<ReadStream, FileReadStream> ||
+    std::is_same_v<ReadStream, BufferedFileReadStream> ||
+    std::is_same_v<ReadStream, MmapReadStream> ||
+    std::is_same_v<ReadStream, AsyncFileReadStream> ||
+    std::is_same_v<ReadStream, StringReadStream> ||
+    std::is_same_v<ReadStream, InsituStringStream>;
+
+/*
+    Reader解析时记录所在容器的显式栈 取代递归
+    嵌套层数超过maxDepth时解析失败 返回PARSE_DEPTH_EXCEEDED
+    同一个ParseStack可用于多次解析 栈空间只在首次加深时分配
+*/
+class ParseStack : noncopyable {
+ public:
+  static constexpr size_t kDefaultMaxDepth = 1024;
+
+  explicit ParseStack(size_t maxDepth = kDefaultMaxDepth)
+      : maxDepth_(maxDepth) {}
+
+  size_t getMaxDepth() const { return maxDepth_; }
+  void setMaxDepth(size_t maxDepth) { maxDepth_ = maxDepth; }
+
+ private:
+  friend Reader;
+  friend StructuralReader;
+
+  // 解析期间把栈标记为占用
+  struct BusyGuard {
+    explicit BusyGuard(ParseStack &stack) : busy_(stack.busy_) {
+      assert(!busy_);
+      busy_ = true;
+    }
+    ~BusyGuard() { busy_ = false; }
+    bool &busy_;
+  };
+
+  std::vector<ValueType> levels_;
+  // 按路径过滤时 每个保留下来的层级对应的前缀树节点和数组下标
+  struct Projection {
+    size_t node;
+    size_t index;
+  };
+  std::vector<Projection> projections_;
+  std::string key_;  // 匹配的key 在其值确定保留后才发给handler
+  size_t maxDepth_;
+  bool busy_ = false;  // 正在被某次解析使用
+};
+
+// 解析选项 按位组合后作为Reader::parse的模板参数 在编译期确定
+// 未开启的选项对应的分支不会出现在生成的代码中
+enum ParseFlag : unsigned {
+  kParseStrictFlags = 0,             // 只接受RFC 8259规定的json
+  kParseNanAndInfFlag = 1 << 0,      // 接受NaN和Infinity
+  kParseNumberSuffixFlag = 1 << 1,   // 接受整数后缀i32和i64
+  kParseValidateUtf8Flag = 1 << 2,   // 校验字符串是否为合法的UTF-8
+  kParseDefaultFlags = kParseNanAndInfFlag | kParseNumberSuffixFlag,
+};
+
+// handler提供bool skipValue()时 Reader在每个key之后调用它
+// 返回true时这个key的值只检查语法 不解码也不发给handler
+template <typename Handler, typename = void>
+inline constexpr bool hasSkipValue = false;
+template <typename Handler>
+inline constexpr bool hasSkipValue<
+    Handler, std::void_t<decltype(std::declval<Handler &>().skipValue())>> =
+    true;
+
 /*
     用于解析json对象 接受一个ReadStream和一个Handler作为参数
     实现对json各种数据类型的解析 包括对象、数组、字符串、数字、布尔值、null
-    还包括double中的NaN和Infinity
+    默认还接受double中的NaN和Infinity 以及整数后缀 可用ParseFlag关闭
     json本身是个object obeject的值和array的内容可以是各种类型
-   因此需根据情况递归解析 并将解析结果传递给handler 利用handler处理结果
+   解析由显式栈驱动的循环完成 不做递归 深层嵌套的输入不会耗尽线程栈
+   解析结果传递给handler 利用handler处理结果
 */
 class Reader : noncopyable {
+  // 两阶段解析器、按需解析和推式解析器复用Reader对字符串、数字和字面量的解析
+  friend StructuralReader;
+  friend OnDemandValue;
+  template <typename Handler, unsigned Flags>
+  friend class PushParser;
+
  public:
-  template <typename ReadStream, typename Handler,
-            typename = std::enable_if_t<
-                std::is_same<ReadStream, FileReadStream>::value ||
-                std::is_same<ReadStream, StringReadStream>::value>>
-  static ParseError parse(ReadStream &is, Handler &handler) {
-    try {
+  // 每个线程复用同一个ParseStack
+  // handler中嵌套调用parse时该栈正被占用 改用临时的栈
+  template <unsigned Flags = kParseDefaultFlags, typename ReadStream,
+            typename Handler,
+            typename = std::enable_if_t<isReadStream<ReadStream>>>
+  static ParseResult parse(ReadStream &is, Handler &handler) {
+    static thread_local ParseStack cached;
+    if (cached.busy_) {
+      ParseStack stack;
+      return parse<Flags>(is, handler, stack);
+    }
+    return parse<Flags>(is, handler, cached);
+  }
+
+  template <unsigned Flags = kParseDefaultFlags, typename ReadStream,
+            typename Handler,
+            typename = std::enable_if_t<isReadStream<ReadStream>>>
+  static ParseResult parse(ReadStream &is, Handler &handler,
+                           ParseStack &stack) {
+    ParseStack::BusyGuard guard(stack);
+
+    stack.levels_.clear();
+    auto begin = is.getConstIter();
+    parseWhiteSpace(is);
+    ParseError err = parseValues<Flags>(is, handler, stack);
+    if (err == ParseError::PARSE_OK) {
       parseWhiteSpace(is);
-      parseValue(is, handler);
+      if (is.hasNext()) err = ParseError::PARSE_ROOT_NOT_SINGULAR;
+    }
+    return ParseResult(err, static_cast<size_t>(is.getConstIter() - begin));
+  }
+
+  // 只检查输入是否为合法的json 不产生事件也不构造任何值
+  // 字符串和数字只检查语法 错误码和出错位置与parse相同
+  template <unsigned Flags = kParseDefaultFlags, typename ReadStream,
+            typename = std::enable_if_t<isReadStream<ReadStream>>>
+  static ParseResult validate(ReadStream &is) {
+    SkipHandler skipper;
+    return parse<Flags>(is, skipper);
+  }
+
+  template <unsigned Flags = kParseDefaultFlags, typename ReadStream,
+            typename = std::enable_if_t<isReadStream<ReadStream>>>
+  static ParseResult validate(ReadStream &is, ParseStack &stack) {
+    SkipHandler skipper;
+    return parse<Flags>(is, skipper, stack);
+  }
+
+  /*
+  按路径过滤的解析 只有filter中路径所指的值才会产生事件
+  通往这些值的对象和数组仍会产生Start/End事件 其中只含有匹配的成员或元素
+  其余的值用跳过器越过: 同样检查语法 错误码与完整解析相同
+  但不解码字符串和数字 也不调用handler
+  */
+  template <unsigned Flags = kParseDefaultFlags, typename ReadStream,
+            typename Handler,
+            typename = std::enable_if_t<isReadStream<ReadStream>>>
+  static ParseResult parse(ReadStream &is, Handler &handler,
+                           const PathFilter &filter) {
+    static thread_local ParseStack cached;
+    if (cached.busy_) {
+      ParseStack stack;
+      return parse<Flags>(is, handler, filter, stack);
+    }
+    return parse<Flags>(is, handler, filter, cached);
+  }
+
+  template <unsigned Flags = kParseDefaultFlags, typename ReadStream,
+            typename Handler,
+            typename = std::enable_if_t<isReadStream<ReadStream>>>
+  static ParseResult parse(ReadStream &is, Handler &handler,
+                           const PathFilter &filter, ParseStack &stack) {
+    ParseStack::BusyGuard guard(stack);
+
+    stack.levels_.clear();
+    stack.projections_.clear();
+    auto begin = is.getConstIter();
+    parseWhiteSpace(is);
+    ParseError err = parseProjected<Flags>(is, handler, filter, stack);
+    if (err == ParseError::PARSE_OK) {
       parseWhiteSpace(is);
-      if (is.hasNext()) throw Exception(ParseError::PARSE_ROOT_NOT_SINGULAR);
-      return ParseError::PARSE_OK;
-    } catch (Exception &e) {
-      return e.err();
+      if (is.hasNext()) err = ParseError::PARSE_ROOT_NOT_SINGULAR;
     }
+    return ParseResult(err, static_cast<size_t>(is.getConstIter() - begin));
   }
 
  private:
-// throw 语句用于抛出一个异常对象。通常是继承自 std::exception
-// 的对象，或者自定义异常类型。
+  // 跳过器和validate使用的handler 不接收任何值
+  // parseString和parseNumber遇到它时只检查语法 不解码
+  struct SkipHandler {
+    bool Null() { return true; }
+    bool Bool(bool) { return true; }
+    bool Int32(int32_t) { return true; }
+    bool Int64(int64_t) { return true; }
+    bool Double(double) { return true; }
+    bool String(std::string_view) { return true; }
+    bool StartObject() { return true; }
+    bool Key(std::string_view) { return true; }
+    bool EndObject() { return true; }
+    bool StartArray() { return true; }
+    bool EndArray() { return true; }
+  };
+  template <typename Handler>
+  static constexpr bool isSkip = std::is_same_v<Handler, SkipHandler>;
+
+// 错误沿返回值逐层传递 不抛异常 格式错误的输入不会引发栈展开
 #define CALL(expr) \
-  if (!(expr)) throw Exception(ParseError::PARSE_USER_STOPPED)
+  if (!(expr)) return ParseError::PARSE_USER_STOPPED
+#define TRY(expr)                                          \
+  do {                                                     \
+    ParseError err_ = (expr);                              \
+    if (__builtin_expect(err_ != ParseError::PARSE_OK, 0)) \
+      return err_;                                         \
+  } while (0)
 
   // Readstream都是字节流 对字节使用next方法逐个解析
 
   // 解析json的转义字符
   // \uXXXX：Unicode 字符，其中 XXXX 是四位十六进制数，表示特定的 Unicode 字符。
-  template <
-      typename ReadStream,
-      typename = std::enable_if_t<std::is_same_v<ReadStream, FileReadStream> ||
-                                  std::is_same_v<ReadStream, StringReadStream>>>
-  static unsigned parseHex4(ReadStream &is) {
-    unsigned u = 0;
+  template <typename ReadStream,
+            typename = std::enable_if_t<isReadStream<ReadStream>>>
+  static ParseError parseHex4(ReadStream &is, unsigned &u) {
+    u = 0;
     for (int i = 0; i < 4; i++) {
       u <<= 4;
       switch (char ch = is.next()) {
@@ -68,33 +260,49 @@ class Reader : noncopyable {
           u |= ch - 'A' + 10;
           break;
         default:
-          throw Exception(ParseError::PARSE_BAD_UNICODE_HEX);
+          return ParseError::PARSE_BAD_UNICODE_HEX;
       }
     }
-    return u;
+    return ParseError::PARSE_OK;
   }
 
-  template <
-      typename ReadStream,
-      typename = std::enable_if_t<std::is_same_v<ReadStream, FileReadStream> ||
-                                  std::is_same_v<ReadStream, StringReadStream>>>
+  template <typename ReadStream,
+            typename = std::enable_if_t<isReadStream<ReadStream>>>
   static void parseWhiteSpace(ReadStream &is) {
-    while (is.hasNext()) {
-      char ch = is.peek();
-      if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n')
-        is.next();
-      else
-        break;
+    // 多数情况下相邻token之间至多一个空白 逐字节判断即可
+    // 连续空白(如缩进)较长时再交给SIMD内核
+    if (!isSpace(is.peek())) return;
+    is.next();
+    if (!isSpace(is.peek())) return;
+    while (true) {
+      std::string_view rest = is.getRemaining();
+      const char *p = rest.data();
+      auto n = static_cast<size_t>(
+          simd::kernels().skipWhiteSpace(p, p + rest.size()) - p);
+      is.skip(n);
+      // 流会重新填充缓冲区时 空白可能延续到下一段
+      if (n < rest.size() || !is.hasNext()) return;
     }
   }
 
+  // 跳过缓冲区中连续的数字 返回跳过的部分
+  // 流会重新填充缓冲区时 数字可能未到结尾 调用方需循环直到下一个字符不是数字
+  template <typename ReadStream,
+            typename = std::enable_if_t<isReadStream<ReadStream>>>
+  static std::string_view skipDigits(ReadStream &is) {
+    std::string_view rest = is.getRemaining();
+    const char *p = rest.data();
+    auto n = static_cast<size_t>(
+        simd::kernels().skipDigits(p, p + rest.size()) - p);
+    is.skip(n);
+    return rest.substr(0, n);
+  }
+
   // litearl 字面量解析
-  template <
-      typename ReadStream, typename Handler,
-      typename = std::enable_if_t<std::is_same_v<ReadStream, FileReadStream> ||
-                                  std::is_same_v<ReadStream, StringReadStream>>>
-  static void parseLiteral(ReadStream &is, Handler &handler,
-                           const char *literal, ValueType type) {
+  template <typename ReadStream, typename Handler,
+            typename = std::enable_if_t<isReadStream<ReadStream>>>
+  static ParseError parseLiteral(ReadStream &is, Handler &handler,
+                                 const char *literal, ValueType type) {
     char ch = *literal;
 
     is.assertNext(*literal++);
@@ -106,50 +314,65 @@ class Reader : noncopyable {
       switch (type) {
         case ValueType::TYPE_NULL:
           CALL(handler.Null());
-          return;
+          return ParseError::PARSE_OK;
         case ValueType::TYPE_BOOL:
           CALL(handler.Bool(ch == 't'));
-          return;
+          return ParseError::PARSE_OK;
         case ValueType::TYPE_DOUBLE:
           CALL(handler.Double(ch == 'N' ? NAN : INFINITY));
-          return;
+          return ParseError::PARSE_OK;
         default:
           assert(false && "bad type");
       }
     }
-    throw Exception(ParseError::PARSE_BAD_VALUE);
+    return ParseError::PARSE_BAD_VALUE;
   }
 
   /*
   解析数字 先解析NaN和Infinity 之后是符号
   起始不可为0  可以是double类型 支持指数形式
-
+  扫描数字的同时累加尾数和十进制指数 不再调用strtod/strtol重新解析:
+  - 整数直接由尾数得到
+  - 浮点数尾数和指数都较小时可精确计算(Clinger快速路径)
+  - 其余情况交给std::from_chars 与locale无关 也不要求输入以'\0'结尾
   */
-  template <
-      typename ReadStream, typename Handler,
-      typename = std::enable_if_t<std::is_same_v<ReadStream, FileReadStream> ||
-                                  std::is_same_v<ReadStream, StringReadStream>>>
-  static void parseNumber(ReadStream &is, Handler &handler) {
-    if (is.peek() == 'N') {
-      parseLiteral(is, handler, "NaN", ValueType::TYPE_DOUBLE);
-      return;
-    } else if (is.peek() == 'I') {
-      parseLiteral(is, handler, "Infinity", ValueType::TYPE_DOUBLE);
-      return;
+  template <unsigned Flags = kParseDefaultFlags, typename ReadStream,
+            typename Handler,
+            typename = std::enable_if_t<isReadStream<ReadStream>>>
+  static ParseError parseNumber(ReadStream &is, Handler &handler) {
+    if constexpr ((Flags & kParseNanAndInfFlag) != 0) {
+      if (is.peek() == 'N') {
+        return parseLiteral(is, handler, "NaN", ValueType::TYPE_DOUBLE);
+      } else if (is.peek() == 'I') {
+        return parseLiteral(is, handler, "Infinity", ValueType::TYPE_DOUBLE);
+      }
     }
 
+    // 会重新填充的流须保留数字开头之后的数据 供from_chars使用
+    struct MarkGuard {
+      explicit MarkGuard(ReadStream &stream) : is_(stream) {
+        if constexpr (isRefillable<ReadStream>) is_.setMark();
+      }
+      ~MarkGuard() {
+        if constexpr (isRefillable<ReadStream>) is_.clearMark();
+      }
+      ReadStream &is_;
+    } guard(is);
     auto start = is.getConstIter();
 
-    if (is.peek() == '-') is.next();
+    bool negative = is.peek() == '-';
+    if (negative) is.next();
 
+    Decimal decimal;
     if (is.peek() == '0') {
       is.next();
-      if (isDigit(is.peek())) throw Exception(ParseError::PARSE_BAD_VALUE);
+      if (isDigit(is.peek())) return ParseError::PARSE_BAD_VALUE;
     } else if (isDigit19(is.peek())) {
-      is.next();
-      while (isDigit(is.peek())) is.next();
+      do {
+        decimal.appendDigits(skipDigits(is));
+      } while (isDigit(is.peek()));
     } else
-      throw Exception(ParseError::PARSE_BAD_VALUE);
+      return ParseError::PARSE_BAD_VALUE;
 
     // number有多个type 需判断
     auto expectType = ValueType::TYPE_NULL;
@@ -158,101 +381,128 @@ class Reader : noncopyable {
     if (is.peek() == '.') {
       expectType = ValueType::TYPE_DOUBLE;
       is.next();
-      if (!isDigit(is.peek())) throw Exception(ParseError::PARSE_BAD_VALUE);
-      while (isDigit(is.peek())) is.next();
+      if (!isDigit(is.peek())) return ParseError::PARSE_BAD_VALUE;
+      do {
+        auto fraction = skipDigits(is);
+        decimal.appendDigits(fraction);
+        decimal.exponent -= static_cast<int>(fraction.size());
+      } while (isDigit(is.peek()));
     }
 
     if (is.peek() == 'e' || is.peek() == 'E') {
       //解析指数
       expectType = ValueType::TYPE_DOUBLE;
       is.next();
+      bool negativeExp = is.peek() == '-';
       if (is.peek() == '+' || is.peek() == '-') is.next();
-      if (!isDigit(is.peek())) throw Exception(ParseError::PARSE_BAD_VALUE);
-      is.next();
-      while (isDigit(is.peek())) is.next();
+      if (!isDigit(is.peek())) return ParseError::PARSE_BAD_VALUE;
+      int e = 0;
+      do {
+        for (char ch : skipDigits(is)) {
+          // 超出double范围的指数只需保持足够大 防止溢出
+          if (e < 100000) e = e * 10 + (ch - '0');
+        }
+      } while (isDigit(is.peek()));
+      decimal.exponent += negativeExp ? -e : e;
     }
 
     // int32 or int64
-    if (is.peek() == 'i') {
-      is.next();
-      if (expectType == ValueType::TYPE_DOUBLE)
-        throw Exception(ParseError::PARSE_BAD_VALUE);
-      switch (is.next()) {
-        case '3':
-          if (is.next() != '2') throw Exception(ParseError::PARSE_BAD_VALUE);
-          expectType = ValueType::TYPE_INT32;
-          break;
-        case '6':
-          if (is.next() != '4') throw Exception(ParseError::PARSE_BAD_VALUE);
-          expectType = ValueType::TYPE_INT64;
-          break;
-        default:
-          throw Exception(ParseError::PARSE_BAD_VALUE);
+    if constexpr ((Flags & kParseNumberSuffixFlag) != 0) {
+      if (is.peek() == 'i') {
+        is.next();
+        if (expectType == ValueType::TYPE_DOUBLE)
+          return ParseError::PARSE_BAD_VALUE;
+        switch (is.next()) {
+          case '3':
+            if (is.next() != '2') return ParseError::PARSE_BAD_VALUE;
+            expectType = ValueType::TYPE_INT32;
+            break;
+          case '6':
+            if (is.next() != '4') return ParseError::PARSE_BAD_VALUE;
+            expectType = ValueType::TYPE_INT64;
+            break;
+          default:
+            return ParseError::PARSE_BAD_VALUE;
+        }
       }
     }
 
-    auto end = is.getConstIter();
-    if (start == end) throw Exception(ParseError::PARSE_BAD_VALUE);
-
-    try {
-      //
-      // std::stod() && std::stoi() are bad ideas,
-      // because new string buffer is needed
-      //
-      // std::stoi(const string& __str, size_t* __idx = 0, int __base = 10) {
-      //     return __gnu_cxx::__stoa<long, int>(&std::strtol, "stoi",
-      //     __str.c_str(),
-      // 		__idx, __base);
-      // }
-      std::size_t idx;
-      if (expectType == ValueType::TYPE_DOUBLE) {
-        //类型转换函数
-        double d = __gnu_cxx::__stoa(&std::strtod, "stod", &*start, &idx);
-        assert(start + idx == end);
-        CALL(handler.Double(d));
-      } else {
-        int64_t i64 =
-            __gnu_cxx::__stoa(&std::strtol, "stol", &*start, &idx, 10);
-        if (expectType == ValueType::TYPE_INT64) {
-          CALL(handler.Int64(i64));
-        } else if (expectType == ValueType::TYPE_INT32) {
-          if (i64 > std::numeric_limits<int32_t>::max() ||
-              i64 < std::numeric_limits<int32_t>::min()) {
-            throw std::out_of_range("int32_t overflow");
-          }
-          CALL(handler.Int32(static_cast<int32_t>(i64)));
-        } else if (i64 <= std::numeric_limits<int32_t>::max() &&
-                   i64 >= std::numeric_limits<int32_t>::min()) {
-          CALL(handler.Int32(static_cast<int32_t>(i64)));
-        } else {
-          CALL(handler.Int64(i64));
-        }
+    if (expectType == ValueType::TYPE_DOUBLE) {
+      // 跳过时只要数量级远离double的上下限 就不会溢出 无需转换
+      if constexpr (isSkip<Handler>) {
+        if (decimal.inSafeRange()) return ParseError::PARSE_OK;
       }
-    } catch (std::out_of_range &e) {
-      throw Exception(ParseError::PARSE_NUMBER_TOO_BIG);
+      const char *begin = &*start;
+      const char *end = begin + (is.getConstIter() - start);
+      double d;
+      TRY(decimal.toDouble(negative, begin, end, d));
+      CALL(handler.Double(d));
+      return ParseError::PARSE_OK;
+    }
+
+    // 整数部分首位非零 不足20位时尾数不会溢出uint64_t
+    // 其中负数最小可到-2^63 正数最大为2^63-1
+    constexpr uint64_t kInt64Max = std::numeric_limits<int64_t>::max();
+    if (decimal.digits > 19 || decimal.mantissa > kInt64Max + negative)
+      return ParseError::PARSE_NUMBER_TOO_BIG;
+    int64_t i64 = negative ? -static_cast<int64_t>(decimal.mantissa - 1) - 1
+                           : static_cast<int64_t>(decimal.mantissa);
+    bool fitsInt32 = i64 <= std::numeric_limits<int32_t>::max() &&
+                     i64 >= std::numeric_limits<int32_t>::min();
+    if (expectType == ValueType::TYPE_INT64) {
+      CALL(handler.Int64(i64));
+    } else if (fitsInt32) {
+      CALL(handler.Int32(static_cast<int32_t>(i64)));
+    } else if (expectType == ValueType::TYPE_INT32) {
+      return ParseError::PARSE_NUMBER_TOO_BIG;
+    } else {
+      CALL(handler.Int64(i64));
     }
+    return ParseError::PARSE_OK;
   }
 
-  template <
-      typename ReadStream, typename Handler,
-      typename = std::enable_if_t<std::is_same_v<ReadStream, FileReadStream> ||
-                                  std::is_same_v<ReadStream, StringReadStream>>>
-  static void parseString(ReadStream &is, Handler &handler, bool isKey) {
+  template <unsigned Flags = kParseDefaultFlags, typename ReadStream,
+            typename Handler,
+            typename = std::enable_if_t<isReadStream<ReadStream>>>
+  static ParseError parseString(ReadStream &is, Handler &handler,
+                                bool isKey) {
+    constexpr bool validateUtf8 = (Flags & kParseValidateUtf8Flag) != 0;
     is.assertNext('"');
-    std::string buffer;
+    // 校验UTF-8时 扫描在不合法的多字节字符处也会停下 交给慢速路径逐字节检查
+    auto scanString = validateUtf8 ? simd::kernels().scanStringUtf8
+                                   : simd::kernels().scanString;
+
+    // 快速路径：用SIMD内核找到第一个 '"' '\\' 或控制字符
+    // 若先遇到的是右引号 说明字符串不含转义 直接把输入中的这一段交给handler
+    std::string_view rest = is.getRemaining();
+    const char *begin = rest.data(), *end = begin + rest.size();
+    const char *special = scanString(begin, end);
+    if (special != end && *special == '"') {
+      std::string_view s(begin, static_cast<size_t>(special - begin));
+      is.skip(s.size() + 1);
+      return emitString(handler, s, isKey);
+    }
+
+    // 慢速路径：含转义的字符串才需要缓冲区 普通字符仍按段拷贝
+    // 原地解析时缓冲区就是输入本身 已扫描的部分无需移动
+    auto buffer = makeStringBuffer<Handler>(is);
+    buffer.append(begin, special);
+    is.skip(buffer.size());
     while (is.hasNext()) {
+      rest = is.getRemaining();
+      begin = rest.data();
+      special = scanString(begin, begin + rest.size());
+      buffer.append(begin, special);
+      is.skip(static_cast<size_t>(special - begin));
+      if (!is.hasNext()) break;
+
       char ch = is.next();
       switch (ch) {
         case '"':
-          if (isKey) {
-            CALL(handler.Key(std::move(buffer)));
-          } else {
-            CALL(handler.String(std::move(buffer)));
-          }
-          return;
+          return emitString(handler, buffer, isKey);
         case '\x01' ... '\x1f':
           // 此为不可打印的字符 是控制字符
-          throw Exception(ParseError::PARSE_BAD_STRING_CHAR);
+          return ParseError::PARSE_BAD_STRING_CHAR;
         case '\\':
           // 转义字符特殊处理 以下是json支持的转义字符
           switch (ch = is.next()) {
@@ -284,113 +534,372 @@ class Reader : noncopyable {
               //  json使用\u  表示unicode码点
               //  json对于utf16里超出BMP的字符 使用两个/u和高低代理项
               //  根据高低代理项可以推算unicode码点
-              unsigned u = parseHex4(is);
+              unsigned u, u2;
+              TRY(parseHex4(is, u));
               if (u >= 0xD800 && u <= 0xDBFF) {
                 if (is.next() != '\\')
-                  throw Exception(ParseError::PARSE_BAD_UNICODE_SURROGATE);
+                  return ParseError::PARSE_BAD_UNICODE_SURROGATE;
                 if (is.next() != 'u')
-                  throw Exception(ParseError::PARSE_BAD_UNICODE_SURROGATE);
-                unsigned u2 = parseHex4(is);
+                  return ParseError::PARSE_BAD_UNICODE_SURROGATE;
+                TRY(parseHex4(is, u2));
                 //下面根据utf16的高低代理项 计算unicode码点
                 if (u2 >= 0xDC00 && u2 <= 0xDFFF)
                   u = 0x10000 + (u - 0xD800) * 0x400 + (u2 - 0xDC00);
                 else
-                  throw Exception(ParseError::PARSE_BAD_UNICODE_SURROGATE);
+                  return ParseError::PARSE_BAD_UNICODE_SURROGATE;
               }
               encodeUtf8(buffer, u);
               break;
             }
             default:
-              throw Exception(ParseError::PARSE_BAD_STRING_ESCAPE);
+              return ParseError::PARSE_BAD_STRING_ESCAPE;
           }
           break;
         default:
-          buffer.push_back(ch);
+          // 扫描停在缓冲区末尾或可疑的多字节字符处
+          if constexpr (validateUtf8) {
+            TRY(parseUtf8Char(is, ch, buffer));
+          } else {
+            buffer.push_back(ch);
+          }
       }
     }
-    throw Exception(ParseError::PARSE_MISS_QUOTATION_MARK);
+    return ParseError::PARSE_MISS_QUOTATION_MARK;
+  }
+
+  // lead为已读取的首字节 逐字节读完这个字符并校验 可跨越重新填充的缓冲区
+  template <typename ReadStream, typename Buffer,
+            typename = std::enable_if_t<isReadStream<ReadStream>>>
+  static ParseError parseUtf8Char(ReadStream &is, char lead, Buffer &buffer) {
+    char bytes[4] = {lead};
+    int n = simd::scalar::utf8SequenceLength(lead);
+    if (n == 0) return ParseError::PARSE_BAD_UTF8;
+    for (int i = 1; i < n; i++) {
+      if ((static_cast<unsigned char>(is.peek()) & 0xc0) != 0x80)
+        return ParseError::PARSE_BAD_UTF8;
+      bytes[i] = is.next();
+    }
+    if (simd::scalar::utf8Length(bytes, bytes + n) != n)
+      return ParseError::PARSE_BAD_UTF8;
+    buffer.append(bytes, bytes + n);
+    return ParseError::PARSE_OK;
   }
 
-  template <
-      typename ReadStream, typename Handler,
-      typename = std::enable_if_t<std::is_same_v<ReadStream, FileReadStream> ||
-                                  std::is_same_v<ReadStream, StringReadStream>>>
-  static void parseArray(ReadStream &is, Handler &handler) {
-    CALL(handler.StartArray());
+  // 原地解析时 解码后的字符直接写回输入缓冲区
+  class InsituBuffer {
+   public:
+    explicit InsituBuffer(char *begin) : begin_(begin), end_(begin) {}
 
-    is.assertNext('[');
-    parseWhiteSpace(is);
-    if (is.peek() == ']') {
-      is.next();
-      CALL(handler.EndArray());
-      return;
+    void push_back(char c) { *end_++ = c; }
+    void append(const char *first, const char *last) {
+      auto n = static_cast<size_t>(last - first);
+      if (first != end_) std::memmove(end_, first, n);
+      end_ += n;
+    }
+    size_t size() const { return static_cast<size_t>(end_ - begin_); }
+    operator std::string_view() const {
+      return std::string_view(begin_, size());
+    }
+
+   private:
+    char *begin_;
+    char *end_;
+  };
+
+  // 跳过时只需检查转义 解码的结果直接丢弃
+  class DiscardBuffer {
+   public:
+    void push_back(char) { size_++; }
+    void append(const char *first, const char *last) {
+      size_ += static_cast<size_t>(last - first);
     }
+    size_t size() const { return size_; }
+    operator std::string_view() const { return std::string_view(); }
+
+   private:
+    size_t size_ = 0;
+  };
+
+  template <typename Handler, typename ReadStream>
+  static auto makeStringBuffer(ReadStream &is) {
+    if constexpr (isSkip<Handler>)
+      return DiscardBuffer();
+    else if constexpr (std::is_same_v<ReadStream, InsituStringStream>)
+      return InsituBuffer(is.getMutableCursor());
+    else
+      return std::string();
+  }
+
+  template <typename Handler>
+  static ParseError emitString(Handler &handler, std::string_view s,
+                               bool isKey) {
+    if (isKey) {
+      CALL(emitKey(handler, s));
+    } else {
+      CALL(handler.String(s));
+    }
+    return ParseError::PARSE_OK;
+  }
+
+  enum class State { VALUE, OBJECT_KEY, AFTER_VALUE };
+
+  // 解析一个完整的值 数组和对象的层级记录在stack中
+  // 事件顺序和错误码与逐层递归解析时相同
+  // 可从已有的层级之上开始 回到开始时的层级即结束
+  template <unsigned Flags = kParseDefaultFlags, typename ReadStream,
+            typename Handler,
+            typename = std::enable_if_t<isReadStream<ReadStream>>>
+  static ParseError parseValues(ReadStream &is, Handler &handler,
+                                ParseStack &stack) {
+    auto &levels = stack.levels_;
+    const size_t base = levels.size();
+    State state = State::VALUE;
 
     while (true) {
-      parseValue(is, handler);
-      parseWhiteSpace(is);
-      switch (is.next()) {
-        case ',':
+      switch (state) {
+        case State::VALUE:
+          if (!is.hasNext()) return ParseError::PARSE_EXPECT_VALUE;
+          switch (is.peek()) {
+            case '[':
+              if (levels.size() >= stack.maxDepth_)
+                return ParseError::PARSE_DEPTH_EXCEEDED;
+              CALL(handler.StartArray());
+              is.next();
+              parseWhiteSpace(is);
+              if (is.peek() == ']') {
+                is.next();
+                CALL(handler.EndArray());
+                state = State::AFTER_VALUE;
+              } else {
+                levels.push_back(ValueType::TYPE_ARRAY);
+              }
+              break;
+            case '{':
+              if (levels.size() >= stack.maxDepth_)
+                return ParseError::PARSE_DEPTH_EXCEEDED;
+              CALL(handler.StartObject());
+              is.next();
+              parseWhiteSpace(is);
+              if (is.peek() == '}') {
+                is.next();
+                CALL(handler.EndObject());
+                state = State::AFTER_VALUE;
+              } else {
+                levels.push_back(ValueType::TYPE_OBJECT);
+                state = State::OBJECT_KEY;
+              }
+              break;
+            default:
+              TRY(parseScalar<Flags>(is, handler));
+              state = State::AFTER_VALUE;
+              break;
+          }
+          break;
+
+        case State::OBJECT_KEY:
+          // parse key
+          if (is.peek() != '"') return ParseError::PARSE_MISS_KEY;
+          TRY(parseString<Flags>(is, handler, true));
           parseWhiteSpace(is);
+
+          if (is.peek() != ':') return ParseError::PARSE_MISS_COLON;
+          is.next();
+          parseWhiteSpace(is);
+          state = State::VALUE;
+          if constexpr (hasSkipValue<Handler>) {
+            if (handler.skipValue()) {
+              SkipHandler skipper;
+              TRY(parseValues<Flags>(is, skipper, stack));
+              state = State::AFTER_VALUE;
+            }
+          }
+          break;
+
+        case State::AFTER_VALUE:
+          if (levels.size() == base) return ParseError::PARSE_OK;
+          parseWhiteSpace(is);
+          if (levels.back() == ValueType::TYPE_ARRAY) {
+            switch (is.peek()) {
+              case ',':
+                is.next();
+                parseWhiteSpace(is);
+                state = State::VALUE;
+                break;
+              case ']':
+                is.next();
+                levels.pop_back();
+                CALL(handler.EndArray());
+                break;
+              default:
+                return ParseError::PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+            }
+          } else {
+            switch (is.peek()) {
+              case ',':
+                is.next();
+                parseWhiteSpace(is);
+                state = State::OBJECT_KEY;
+                break;
+              case '}':
+                is.next();
+                levels.pop_back();
+                CALL(handler.EndObject());
+                break;
+              default:
+                return ParseError::PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+            }
+          }
           break;
-        case ']':
-          CALL(handler.EndArray());
-          return;
-        default:
-          throw Exception(ParseError::PARSE_MISS_COMMA_OR_SQUARE_BRACKET);
       }
     }
   }
 
-  template <
-      typename ReadStream, typename Handler,
-      typename = std::enable_if_t<std::is_same_v<ReadStream, FileReadStream> ||
-                                  std::is_same_v<ReadStream, StringReadStream>>>
-  static void parseObject(ReadStream &is, Handler &handler) {
-    CALL(handler.StartObject());
-
-    is.assertNext('{');
-    parseWhiteSpace(is);
-    if (is.peek() == '}') {
-      is.next();
-      CALL(handler.EndObject());
-      return;
+  // 对象的key只用于在前缀树中查找 匹配时才保存下来
+  struct KeyMatcher {
+    bool Key(std::string_view s) {
+      child = filter.findChild(parent, s);
+      if (child != PathFilter::kNone) key.assign(s.data(), s.size());
+      return true;
     }
+    bool String(std::string_view) { return true; }
+
+    const PathFilter &filter;
+    size_t parent;
+    std::string &key;
+    size_t child = PathFilter::kNone;
+  };
+
+  // 与parseValues相同的状态机 但只进入能通往filter中路径的对象和数组
+  // 保留下来的层级同时记录在levels_和projections_中
+  template <unsigned Flags = kParseDefaultFlags, typename ReadStream,
+            typename Handler,
+            typename = std::enable_if_t<isReadStream<ReadStream>>>
+  static ParseError parseProjected(ReadStream &is, Handler &handler,
+                                   const PathFilter &filter,
+                                   ParseStack &stack) {
+    auto &levels = stack.levels_;
+    auto &projections = stack.projections_;
+    SkipHandler skipper;
+    size_t node = PathFilter::root();  // 当前值在前缀树中对应的节点
+    bool hasKey = false;  // 当前值是对象的成员 其key尚未发给handler
+    State state = State::VALUE;
 
     while (true) {
-      // parse key
-      if (is.peek() != '"') throw Exception(ParseError::PARSE_MISS_KEY);
-      parseString(is, handler, true);
-      parseWhiteSpace(is);
+      switch (state) {
+        case State::VALUE: {
+          char ch = is.peek();
+          bool matched = node != PathFilter::kNone;
+          if (matched && filter.isTerminal(node)) {
+            // 路径所指的值 完整解析
+            if (hasKey) CALL(emitKey(handler, stack.key_));
+            TRY(parseValues<Flags>(is, handler, stack));
+            state = State::AFTER_VALUE;
+          } else if (matched && (ch == '[' || ch == '{') &&
+                     filter.hasChildren(node)) {
+            // 通往路径的容器 只进入其中匹配的成员或元素
+            if (levels.size() >= stack.maxDepth_)
+              return ParseError::PARSE_DEPTH_EXCEEDED;
+            if (hasKey) CALL(emitKey(handler, stack.key_));
+            bool isArray = ch == '[';
+            if (isArray) {
+              CALL(handler.StartArray());
+            } else {
+              CALL(handler.StartObject());
+            }
+            is.next();
+            parseWhiteSpace(is);
+            if (is.peek() == (isArray ? ']' : '}')) {
+              is.next();
+              if (isArray) {
+                CALL(handler.EndArray());
+              } else {
+                CALL(handler.EndObject());
+              }
+              state = State::AFTER_VALUE;
+            } else {
+              levels.push_back(isArray ? ValueType::TYPE_ARRAY
+                                       : ValueType::TYPE_OBJECT);
+              projections.push_back({node, 0});
+              if (isArray) {
+                node = filter.findChild(node, static_cast<size_t>(0));
+              } else {
+                state = State::OBJECT_KEY;
+              }
+            }
+          } else {
+            // 不在路径上 key和值都不发给handler
+            TRY(parseValues<Flags>(is, skipper, stack));
+            state = State::AFTER_VALUE;
+          }
+          hasKey = false;
+          break;
+        }
 
-      if (is.next() != ':') throw Exception(ParseError::PARSE_MISS_COLON);
-      parseWhiteSpace(is);
+        case State::OBJECT_KEY: {
+          if (is.peek() != '"') return ParseError::PARSE_MISS_KEY;
+          KeyMatcher matcher{filter, projections.back().node, stack.key_};
+          TRY(parseString<Flags>(is, matcher, true));
+          node = matcher.child;
+          hasKey = true;
+          parseWhiteSpace(is);
 
-      // parse value
-      // value可以是各种类型 所以这里要调用value value会判断类型
-      parseValue(is, handler);
-      parseWhiteSpace(is);
-      switch (is.next()) {
-        case ',':
+          if (is.peek() != ':') return ParseError::PARSE_MISS_COLON;
+          is.next();
           parseWhiteSpace(is);
+          state = State::VALUE;
+          break;
+        }
+
+        case State::AFTER_VALUE:
+          if (levels.empty()) return ParseError::PARSE_OK;
+          parseWhiteSpace(is);
+          if (levels.back() == ValueType::TYPE_ARRAY) {
+            switch (is.peek()) {
+              case ',': {
+                is.next();
+                parseWhiteSpace(is);
+                auto &array = projections.back();
+                node = filter.findChild(array.node, ++array.index);
+                state = State::VALUE;
+                break;
+              }
+              case ']':
+                is.next();
+                levels.pop_back();
+                projections.pop_back();
+                CALL(handler.EndArray());
+                break;
+              default:
+                return ParseError::PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+            }
+          } else {
+            switch (is.peek()) {
+              case ',':
+                is.next();
+                parseWhiteSpace(is);
+                state = State::OBJECT_KEY;
+                break;
+              case '}':
+                is.next();
+                levels.pop_back();
+                projections.pop_back();
+                CALL(handler.EndObject());
+                break;
+              default:
+                return ParseError::PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+            }
+          }
           break;
-        case '}':
-          CALL(handler.EndObject());
-          return;
-        default:
-          throw Exception(ParseError::PARSE_MISS_COMMA_OR_CURLY_BRACKET);
       }
     }
   }
 
-#undef CALL
-
-  template <
-      typename ReadStream, typename Handler,
-      typename = std::enable_if_t<std::is_same_v<ReadStream, FileReadStream> ||
-                                  std::is_same_v<ReadStream, StringReadStream>>>
-  static void parseValue(ReadStream &is, Handler &handler) {
-    if (!is.hasNext()) throw Exception(ParseError::PARSE_EXPECT_VALUE);
+  // 解析数组和对象以外的值
+  template <unsigned Flags = kParseDefaultFlags, typename ReadStream,
+            typename Handler,
+            typename = std::enable_if_t<isReadStream<ReadStream>>>
+  static ParseError parseScalar(ReadStream &is, Handler &handler) {
+    if (!is.hasNext()) return ParseError::PARSE_EXPECT_VALUE;
 
     switch (is.peek()) {
       case 'n':
@@ -400,20 +909,90 @@ class Reader : noncopyable {
       case 'f':
         return parseLiteral(is, handler, "false", ValueType::TYPE_BOOL);
       case '"':
-        return parseString(is, handler, false);
-      case '[':
-        return parseArray(is, handler);
-      case '{':
-        return parseObject(is, handler);
+        return parseString<Flags>(is, handler, false);
       default:
-        return parseNumber(is, handler);
+        return parseNumber<Flags>(is, handler);
     }
   }
 
+#undef TRY
+#undef CALL
+
  private:
+  static bool isSpace(char ch) { return simd::scalar::isSpace(ch); }
   static bool isDigit(char ch) { return ch >= '0' && ch <= '9'; }
   static bool isDigit19(char ch) { return ch >= '1' && ch <= '9'; }
-  static inline void encodeUtf8(std::string &buffer, unsigned u);
+
+  // 解析数字时累加的十进制表示 值为mantissa * 10^exponent
+  struct Decimal {
+    uint64_t mantissa = 0;
+    int digits = 0;  // 有效数字位数 不含前导零 超过19位后不再累加
+    int exponent = 0;
+
+    void appendDigits(std::string_view s) {
+      for (char ch : s) {
+        if (digits < 19) {
+          mantissa = mantissa * 10 + static_cast<uint64_t>(ch - '0');
+          if (mantissa != 0) digits++;
+        } else {
+          digits++;
+        }
+      }
+    }
+
+    // 尾数不超过19位时 值小于10^(19+exponent) 且非零时不小于10^exponent
+    bool inSafeRange() const {
+      return mantissa == 0 ||
+             (digits <= 19 && exponent >= -300 && exponent <= 280);
+    }
+
+    // [begin, end)为数字的原文 快速路径不适用时交给from_chars
+    ParseError toDouble(bool negative, const char *begin, const char *end,
+                        double &d) const {
+      // 10^0 ~ 10^22 都能用double精确表示
+      static constexpr double kPow10[] = {
+          1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+          1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+          1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+      constexpr uint64_t kMaxExactInt = static_cast<uint64_t>(1) << 53;
+
+      if (mantissa == 0) {
+        d = negative ? -0.0 : 0.0;
+        return ParseError::PARSE_OK;
+      }
+      // Clinger: 尾数和10的幂都能精确表示时 一次乘除的结果就是正确舍入的
+      if (digits <= 19 && mantissa <= kMaxExactInt) {
+        d = static_cast<double>(mantissa);
+        bool exact = true;
+        if (exponent < 0 && exponent >= -22) {
+          d /= kPow10[-exponent];
+        } else if (exponent >= 0 && exponent <= 22) {
+          d *= kPow10[exponent];
+        } else if (exponent > 22 && exponent <= 22 + 15) {
+          // 指数稍大时 先把多出的部分乘进尾数 只要尾数仍能精确表示
+          uint64_t m = mantissa;
+          for (int i = 22; i < exponent && m <= kMaxExactInt; i++) m *= 10;
+          exact = m <= kMaxExactInt;
+          d = static_cast<double>(m) * kPow10[22];
+        } else {
+          exact = false;
+        }
+        if (exact) {
+          if (negative) d = -d;
+          return ParseError::PARSE_OK;
+        }
+      }
+
+      auto [ptr, ec] = std::from_chars(begin, end, d);
+      if (ec == std::errc::result_out_of_range)
+        return ParseError::PARSE_NUMBER_TOO_BIG;
+      assert(ec == std::errc() && ptr == end);
+      (void)ptr;
+      return ParseError::PARSE_OK;
+    }
+  };
+  template <typename Buffer>
+  static inline void encodeUtf8(Buffer &buffer, unsigned u);
 };
 }  // namespace json
 }  // namespace goa
@@ -456,7 +1035,8 @@ pairs）来表示。 这些字符由一个高代理码点和一个低代理码
 
 cpp的string可以存储utf8格式的字符串 eg:"hello,世界"
 */
-inline void goa::json::Reader::encodeUtf8(std::string &buffer, unsigned u) {
+template <typename Buffer>
+inline void goa::json::Reader::encodeUtf8(Buffer &buffer, unsigned u) {
   // unicode stuff from Milo's tutorial
   // 判断u在上面哪个范围内 将unicode码点 编码为 utf8格式
 
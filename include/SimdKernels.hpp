@@ -0,0 +1,752 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define GOA_JSON_X86 1
+#include <immintrin.h>
+#endif
+
+namespace goa {
+
+namespace json {
+
+/*
+向量化的字节扫描内核 供Reader、Writer和StructuralIndex使用
+每个内核都有scalar、SSE4.2、AVX2、AVX-512四个版本
+SIMD版本通过__attribute__((target))单独编译 不依赖-march=native
+程序第一次调用kernels()时根据CPUID选出当前机器支持的最宽版本 之后不再改变
+因此同一个二进制文件可以部署到不同代际的机器上
+*/
+namespace simd {
+
+// 64字节块的字符分类 每一位对应块内一个字节
+struct CharClassMasks {
+  uint64_t quote;
+  uint64_t backslash;
+  uint64_t op;  // { } [ ] : ,
+  uint64_t space;
+  uint64_t control;  // 控制字符(< 0x20) 含空白中的\t \n \r
+};
+
+enum class SimdLevel { SCALAR, SSE42, AVX2, AVX512 };
+
+struct Kernels {
+  SimdLevel level;
+  const char *name;
+  // 返回第一个非空白字符的位置 没有则返回end
+  const char *(*skipWhiteSpace)(const char *p, const char *end);
+  // 返回第一个 '"'、'\\' 或控制字符(< 0x20)的位置 没有则返回end
+  // 解析时用来找字符串的结尾或转义 输出时用来找需要转义的字符
+  const char *(*scanString)(const char *p, const char *end);
+  // 与scanString相同 同时校验UTF-8
+  // 遇到不合法(或在end前被截断)的多字节字符时 返回该字符第一个字节的位置
+  const char *(*scanStringUtf8)(const char *p, const char *end);
+  // 返回第一个非数字字符的位置 没有则返回end
+  const char *(*skipDigits)(const char *p, const char *end);
+  // 对p开始的64字节分类 p之后必须有64字节可读
+  CharClassMasks (*classify)(const char *p);
+};
+
+namespace scalar {
+
+inline bool isSpace(char ch) {
+  return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+inline bool isStringSpecial(char ch) {
+  auto u = static_cast<unsigned char>(ch);
+  return u == '"' || u == '\\' || u < 0x20;
+}
+
+inline const char *skipWhiteSpace(const char *p, const char *end) {
+  while (p < end && isSpace(*p)) p++;
+  return p;
+}
+
+inline const char *scanString(const char *p, const char *end) {
+  while (p < end && !isStringSpecial(*p)) p++;
+  return p;
+}
+
+inline const char *skipDigits(const char *p, const char *end) {
+  while (p < end && *p >= '0' && *p <= '9') p++;
+  return p;
+}
+
+// 由首字节得到UTF-8字符的字节数 不能作为首字节时返回0
+inline int utf8SequenceLength(char lead) {
+  auto c = static_cast<unsigned char>(lead);
+  if (c < 0x80) return 1;
+  if (c >= 0xc2 && c <= 0xdf) return 2;
+  if (c >= 0xe0 && c <= 0xef) return 3;
+  if (c >= 0xf0 && c <= 0xf4) return 4;
+  return 0;
+}
+
+// p处合法UTF-8字符的字节数 不合法或在end前被截断时返回0
+// 拒绝过长编码、代理项和超过U+10FFFF的码点
+inline int utf8Length(const char *p, const char *end) {
+  int n = utf8SequenceLength(*p);
+  if (n <= 1 || end - p < n) return n == 1 ? 1 : 0;
+  static constexpr uint32_t kMin[] = {0, 0, 0x80, 0x800, 0x10000};
+  uint32_t cp = static_cast<unsigned char>(*p) & (0x7f >> n);
+  for (int i = 1; i < n; i++) {
+    auto c = static_cast<unsigned char>(p[i]);
+    if ((c & 0xc0) != 0x80) return 0;
+    cp = cp << 6 | (c & 0x3f);
+  }
+  if (cp < kMin[n] || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff))
+    return 0;
+  return n;
+}
+
+inline const char *scanStringUtf8(const char *p, const char *end) {
+  while (p < end) {
+    if (isStringSpecial(*p)) return p;
+    int n = utf8Length(p, end);
+    if (n == 0) return p;
+    p += n;
+  }
+  return end;
+}
+
+// 向量化校验时 字符的错误要到其后1~3个字节处才能发现
+// p之前都未发现错误时 只有从p-3起的字符尚未确认 返回其中第一个字符的开头
+inline const char *utf8Restart(const char *begin, const char *p) {
+  p -= p - begin < 3 ? p - begin : 3;
+  while (p > begin && (static_cast<unsigned char>(*p) & 0xc0) == 0x80) p--;
+  return p;
+}
+
+inline CharClassMasks classify(const char *p) {
+  CharClassMasks masks{0, 0, 0, 0, 0};
+  for (int i = 0; i < 64; i++) {
+    uint64_t bit = uint64_t(1) << i;
+    if (static_cast<unsigned char>(p[i]) < 0x20) masks.control |= bit;
+    switch (p[i]) {
+      case '"':
+        masks.quote |= bit;
+        break;
+      case '\\':
+        masks.backslash |= bit;
+        break;
+      case '{':
+      case '}':
+      case '[':
+      case ']':
+      case ':':
+      case ',':
+        masks.op |= bit;
+        break;
+      case ' ':
+      case '\t':
+      case '\n':
+      case '\r':
+        masks.space |= bit;
+        break;
+      default:
+        break;
+    }
+  }
+  return masks;
+}
+
+}  // namespace scalar
+
+/*
+UTF-8的向量化校验 采用Keiser和Lemire的查表法
+每个字节与前一个字节各取高低4位查三张表 三个结果按位与 非零即为错误
+每一位代表一类错误 只有两个字节同时符合时该位才保留
+3、4字节字符的第3、4个字节是否应为后续字节 另由前2、3个字节判断
+*/
+namespace utf8 {
+
+// 注释中为两个字节的模式 前一个字节在左
+constexpr uint8_t kTooShort = 1 << 0;      // 11______ 0_______/11______
+constexpr uint8_t kTooLong = 1 << 1;       // 0_______ 10______
+constexpr uint8_t kOverlong3 = 1 << 2;     // 11100000 100_____
+constexpr uint8_t kTooLarge = 1 << 3;      // 11110100 1001____ 等
+constexpr uint8_t kSurrogate = 1 << 4;     // 11101101 101_____
+constexpr uint8_t kOverlong2 = 1 << 5;     // 1100000_ 10______
+constexpr uint8_t kTooLarge1000 = 1 << 6;  // 11110101 1000____ 等
+constexpr uint8_t kOverlong4 = 1 << 6;     // 11110000 1000____
+constexpr uint8_t kTwoConts = 1 << 7;      // 10______ 10______
+constexpr uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+
+// 以前一个字节的高4位为下标
+alignas(16) inline constexpr uint8_t kByte1High[16] = {
+    kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong,
+    kTooLong, kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+    kTooShort | kOverlong2, kTooShort, kTooShort | kOverlong3 | kSurrogate,
+    kTooShort | kTooLarge | kTooLarge1000 | kOverlong4};
+
+// 以前一个字节的低4位为下标
+alignas(16) inline constexpr uint8_t kByte1Low[16] = {
+    kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+    kCarry | kOverlong2,
+    kCarry,
+    kCarry,
+    kCarry | kTooLarge,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000};
+
+// 以当前字节的高4位为下标
+alignas(16) inline constexpr uint8_t kByte2High[16] = {
+    kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort,
+    kTooShort, kTooShort,
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 |
+        kOverlong4,
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    kTooShort, kTooShort, kTooShort, kTooShort};
+
+}  // namespace utf8
+
+#if defined(GOA_JSON_X86)
+
+#define GOA_JSON_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define GOA_JSON_TARGET_AVX2 __attribute__((target("avx2")))
+#define GOA_JSON_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+
+namespace sse42 {
+
+// PCMPISTRI/PCMPESTRI 一条指令完成16字节与字符集合(或区间)的比较
+GOA_JSON_TARGET_SSE42 inline const char *skipWhiteSpace(const char *p,
+                                                        const char *end) {
+  // 隐式长度的集合 数据中遇到'\0'也会停止 '\0'本就不是空白
+  alignas(16) static const char spaces[16] = " \t\n\r";
+  const __m128i set = _mm_load_si128(reinterpret_cast<const __m128i *>(spaces));
+  for (; p + 16 <= end; p += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    int idx = _mm_cmpistri(set, v,
+                           _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY |
+                               _SIDD_LEAST_SIGNIFICANT |
+                               _SIDD_NEGATIVE_POLARITY);
+    if (idx != 16) return p + idx;
+  }
+  return scalar::skipWhiteSpace(p, end);
+}
+
+GOA_JSON_TARGET_SSE42 inline const char *scanString(const char *p,
+                                                    const char *end) {
+  // 区间 ["", "] [\, \] [0x00, 0x1f] 显式长度 数据中的'\0'同样参与比较
+  alignas(16) static const char ranges[16] = {'"', '"', '\\', '\\', 0, 0x1f};
+  const __m128i set = _mm_load_si128(reinterpret_cast<const __m128i *>(ranges));
+  for (; p + 16 <= end; p += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    int idx = _mm_cmpestri(set, 6, v, 16,
+                           _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES |
+                               _SIDD_LEAST_SIGNIFICANT);
+    if (idx != 16) return p + idx;
+  }
+  return scalar::scanString(p, end);
+}
+
+GOA_JSON_TARGET_SSE42 inline const char *skipDigits(const char *p,
+                                                    const char *end) {
+  alignas(16) static const char digits[16] = "09";
+  const __m128i set = _mm_load_si128(reinterpret_cast<const __m128i *>(digits));
+  for (; p + 16 <= end; p += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    int idx = _mm_cmpistri(set, v,
+                           _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES |
+                               _SIDD_LEAST_SIGNIFICANT |
+                               _SIDD_NEGATIVE_POLARITY);
+    if (idx != 16) return p + idx;
+  }
+  return scalar::skipDigits(p, end);
+}
+
+GOA_JSON_TARGET_SSE42 inline __m128i lookup(const uint8_t *table,
+                                            __m128i index) {
+  __m128i t = _mm_load_si128(reinterpret_cast<const __m128i *>(table));
+  return _mm_shuffle_epi8(t, index);
+}
+
+// 每个字节非零表示在该字节处发现UTF-8错误 prev为前16个字节
+GOA_JSON_TARGET_SSE42 inline __m128i utf8Errors(__m128i v, __m128i prev) {
+  const __m128i low4 = _mm_set1_epi8(0x0f);
+  __m128i prev1 = _mm_alignr_epi8(v, prev, 15);
+  __m128i prev2 = _mm_alignr_epi8(v, prev, 14);
+  __m128i prev3 = _mm_alignr_epi8(v, prev, 13);
+  __m128i special = _mm_and_si128(
+      _mm_and_si128(
+          lookup(utf8::kByte1High,
+                 _mm_and_si128(_mm_srli_epi16(prev1, 4), low4)),
+          lookup(utf8::kByte1Low, _mm_and_si128(prev1, low4))),
+      lookup(utf8::kByte2High, _mm_and_si128(_mm_srli_epi16(v, 4), low4)));
+  // 前2个字节为1110____或前3个字节为11110___时 当前字节必须是后续字节
+  __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8(0xe0 - 0x80));
+  __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(0xf0 - 0x80));
+  __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth),
+                                 _mm_set1_epi8(static_cast<char>(0x80)));
+  return _mm_xor_si128(must23, special);
+}
+
+GOA_JSON_TARGET_SSE42 inline uint32_t stringSpecialMask(__m128i v) {
+  __m128i special = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                   _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+      _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1f)), v));
+  return static_cast<uint32_t>(_mm_movemask_epi8(special));
+}
+
+// 16字节一块 块内既有特殊字符又有UTF-8错误时 由scalar版本确定位置
+GOA_JSON_TARGET_SSE42 inline const char *scanStringUtf8(const char *p,
+                                                        const char *end) {
+  const char *begin = p;
+  __m128i prev = _mm_setzero_si128();
+  bool prevAscii = true;
+  char tail[16];
+  for (; p < end; p += 16) {
+    __m128i v;
+    if (end - p >= 16) {
+      v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    } else {
+      // 以空白补齐 被截断的字符在补齐处报错
+      std::memset(tail, ' ', sizeof(tail));
+      std::memcpy(tail, p, static_cast<size_t>(end - p));
+      v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tail));
+    }
+    uint64_t special = stringSpecialMask(v);
+    bool ascii = _mm_movemask_epi8(v) == 0;
+    uint64_t errors = 0;
+    if (!ascii || !prevAscii) {
+      __m128i ok = _mm_cmpeq_epi8(utf8Errors(v, prev), _mm_setzero_si128());
+      errors = ~static_cast<uint64_t>(_mm_movemask_epi8(ok)) & 0xffff;
+    }
+    if ((special | errors) != 0) {
+      // 第一个特殊字符及其之前都没有错误
+      if (special != 0 && (errors & (special ^ (special - 1))) == 0)
+        return p + __builtin_ctzll(special);
+      return scalar::scanStringUtf8(scalar::utf8Restart(begin, p), end);
+    }
+    prev = v;
+    prevAscii = ascii;
+  }
+  // 末尾恰好是整块时 最后几个字节中的错误要到下一块才能发现
+  if (!prevAscii)
+    return scalar::scanStringUtf8(scalar::utf8Restart(begin, end), end);
+  return end;
+}
+
+GOA_JSON_TARGET_SSE42 inline uint64_t movemask(__m128i v0, __m128i v1,
+                                               __m128i v2, __m128i v3) {
+  auto m0 = static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(v0)));
+  auto m1 = static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(v1)));
+  auto m2 = static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(v2)));
+  auto m3 = static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(v3)));
+  return m0 | m1 << 16 | m2 << 32 | m3 << 48;
+}
+
+GOA_JSON_TARGET_SSE42 inline __m128i opMask(__m128i v) {
+  // '[' | 0x20 == '{'  ']' | 0x20 == '}'
+  __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+  return _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi8(lower, _mm_set1_epi8('{')),
+                   _mm_cmpeq_epi8(lower, _mm_set1_epi8('}'))),
+      _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')),
+                   _mm_cmpeq_epi8(v, _mm_set1_epi8(','))));
+}
+
+GOA_JSON_TARGET_SSE42 inline __m128i spaceMask(__m128i v) {
+  return _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                   _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+                      _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')),
+                                   _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+}
+
+// v <= 0x1f (等价于 min(v, 0x1f) == v)
+GOA_JSON_TARGET_SSE42 inline __m128i controlMask(__m128i v) {
+  return _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1f)), v);
+}
+
+GOA_JSON_TARGET_SSE42 inline CharClassMasks classify(const char *p) {
+  const __m128i *in = reinterpret_cast<const __m128i *>(p);
+  __m128i v0 = _mm_loadu_si128(in), v1 = _mm_loadu_si128(in + 1);
+  __m128i v2 = _mm_loadu_si128(in + 2), v3 = _mm_loadu_si128(in + 3);
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+
+  CharClassMasks masks;
+  masks.quote =
+      movemask(_mm_cmpeq_epi8(v0, quote), _mm_cmpeq_epi8(v1, quote),
+               _mm_cmpeq_epi8(v2, quote), _mm_cmpeq_epi8(v3, quote));
+  masks.backslash = movemask(
+      _mm_cmpeq_epi8(v0, backslash), _mm_cmpeq_epi8(v1, backslash),
+      _mm_cmpeq_epi8(v2, backslash), _mm_cmpeq_epi8(v3, backslash));
+  masks.op = movemask(opMask(v0), opMask(v1), opMask(v2), opMask(v3));
+  masks.space =
+      movemask(spaceMask(v0), spaceMask(v1), spaceMask(v2), spaceMask(v3));
+  masks.control = movemask(controlMask(v0), controlMask(v1), controlMask(v2),
+                           controlMask(v3));
+  return masks;
+}
+
+}  // namespace sse42
+
+namespace avx2 {
+
+GOA_JSON_TARGET_AVX2 inline __m256i load(const char *p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+
+GOA_JSON_TARGET_AVX2 inline uint32_t movemask(__m256i v) {
+  return static_cast<uint32_t>(_mm256_movemask_epi8(v));
+}
+
+GOA_JSON_TARGET_AVX2 inline __m256i spaceMask(__m256i v) {
+  return _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                      _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+      _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+                      _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+}
+
+// 区分 '"' '\\' 以及 v <= 0x1f (等价于 min(v, 0x1f) == v)
+GOA_JSON_TARGET_AVX2 inline __m256i stringSpecialMask(__m256i v) {
+  return _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')),
+                      _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+      _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x1f)), v));
+}
+
+// v - '0' <= 9 (无符号)
+GOA_JSON_TARGET_AVX2 inline __m256i digitMask(__m256i v) {
+  __m256i d = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+  return _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+}
+
+GOA_JSON_TARGET_AVX2 inline __m256i opMask(__m256i v) {
+  __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+  return _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(lower, _mm256_set1_epi8('{')),
+                      _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('}'))),
+      _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')),
+                      _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))));
+}
+
+// 32字节一步 剩余部分交给SSE4.2版本
+GOA_JSON_TARGET_AVX2 inline const char *skipWhiteSpace(const char *p,
+                                                       const char *end) {
+  for (; p + 32 <= end; p += 32) {
+    uint32_t mask = ~movemask(spaceMask(load(p)));
+    if (mask != 0) return p + __builtin_ctz(mask);
+  }
+  return sse42::skipWhiteSpace(p, end);
+}
+
+GOA_JSON_TARGET_AVX2 inline const char *scanString(const char *p,
+                                                   const char *end) {
+  for (; p + 32 <= end; p += 32) {
+    uint32_t mask = movemask(stringSpecialMask(load(p)));
+    if (mask != 0) return p + __builtin_ctz(mask);
+  }
+  return sse42::scanString(p, end);
+}
+
+GOA_JSON_TARGET_AVX2 inline const char *skipDigits(const char *p,
+                                                   const char *end) {
+  for (; p + 32 <= end; p += 32) {
+    uint32_t mask = ~movemask(digitMask(load(p)));
+    if (mask != 0) return p + __builtin_ctz(mask);
+  }
+  return sse42::skipDigits(p, end);
+}
+
+GOA_JSON_TARGET_AVX2 inline __m256i lookup(const uint8_t *table,
+                                           __m256i index) {
+  __m256i t = _mm256_broadcastsi128_si256(
+      _mm_load_si128(reinterpret_cast<const __m128i *>(table)));
+  return _mm256_shuffle_epi8(t, index);
+}
+
+// 与sse42::utf8Errors相同 prev为前32个字节
+GOA_JSON_TARGET_AVX2 inline __m256i utf8Errors(__m256i v, __m256i prev) {
+  const __m256i low4 = _mm256_set1_epi8(0x0f);
+  // 低128位取prev的高128位 高128位取v的低128位 与v拼接后错位
+  __m256i shifted = _mm256_permute2x128_si256(prev, v, 0x21);
+  __m256i prev1 = _mm256_alignr_epi8(v, shifted, 15);
+  __m256i prev2 = _mm256_alignr_epi8(v, shifted, 14);
+  __m256i prev3 = _mm256_alignr_epi8(v, shifted, 13);
+  __m256i special = _mm256_and_si256(
+      _mm256_and_si256(
+          lookup(utf8::kByte1High,
+                 _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low4)),
+          lookup(utf8::kByte1Low, _mm256_and_si256(prev1, low4))),
+      lookup(utf8::kByte2High,
+             _mm256_and_si256(_mm256_srli_epi16(v, 4), low4)));
+  __m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8(0xe0 - 0x80));
+  __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xf0 - 0x80));
+  __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth),
+                                    _mm256_set1_epi8(static_cast<char>(0x80)));
+  return _mm256_xor_si256(must23, special);
+}
+
+GOA_JSON_TARGET_AVX2 inline const char *scanStringUtf8(const char *p,
+                                                       const char *end) {
+  const char *begin = p;
+  __m256i prev = _mm256_setzero_si256();
+  bool prevAscii = true;
+  char tail[32];
+  for (; p < end; p += 32) {
+    __m256i v;
+    if (end - p >= 32) {
+      v = load(p);
+    } else {
+      std::memset(tail, ' ', sizeof(tail));
+      std::memcpy(tail, p, static_cast<size_t>(end - p));
+      v = load(tail);
+    }
+    uint64_t special = movemask(stringSpecialMask(v));
+    bool ascii = movemask(v) == 0;
+    uint64_t errors = 0;
+    if (!ascii || !prevAscii) {
+      __m256i ok =
+          _mm256_cmpeq_epi8(utf8Errors(v, prev), _mm256_setzero_si256());
+      errors = ~static_cast<uint64_t>(movemask(ok)) & 0xffffffff;
+    }
+    if ((special | errors) != 0) {
+      if (special != 0 && (errors & (special ^ (special - 1))) == 0)
+        return p + __builtin_ctzll(special);
+      return scalar::scanStringUtf8(scalar::utf8Restart(begin, p), end);
+    }
+    prev = v;
+    prevAscii = ascii;
+  }
+  if (!prevAscii)
+    return scalar::scanStringUtf8(scalar::utf8Restart(begin, end), end);
+  return end;
+}
+
+GOA_JSON_TARGET_AVX2 inline uint64_t combine(__m256i lo, __m256i hi) {
+  return static_cast<uint64_t>(movemask(lo)) |
+         static_cast<uint64_t>(movemask(hi)) << 32;
+}
+
+GOA_JSON_TARGET_AVX2 inline CharClassMasks classify(const char *p) {
+  __m256i lo = load(p), hi = load(p + 32);
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i backslash = _mm256_set1_epi8('\\');
+
+  CharClassMasks masks;
+  masks.quote =
+      combine(_mm256_cmpeq_epi8(lo, quote), _mm256_cmpeq_epi8(hi, quote));
+  masks.backslash = combine(_mm256_cmpeq_epi8(lo, backslash),
+                            _mm256_cmpeq_epi8(hi, backslash));
+  masks.op = combine(opMask(lo), opMask(hi));
+  masks.space = combine(spaceMask(lo), spaceMask(hi));
+  const __m256i control = _mm256_set1_epi8(0x1f);
+  masks.control =
+      combine(_mm256_cmpeq_epi8(_mm256_min_epu8(lo, control), lo),
+              _mm256_cmpeq_epi8(_mm256_min_epu8(hi, control), hi));
+  return masks;
+}
+
+}  // namespace avx2
+
+namespace avx512 {
+
+// 末尾不足64字节时用带掩码的加载 被屏蔽的字节不会访问内存
+GOA_JSON_TARGET_AVX512 inline __m512i load(const char *p, const char *end,
+                                           __mmask64 &valid) {
+  auto left = static_cast<size_t>(end - p);
+  if (left >= 64) {
+    valid = ~__mmask64(0);
+    return _mm512_loadu_si512(p);
+  }
+  valid = (__mmask64(1) << left) - 1;
+  return _mm512_maskz_loadu_epi8(valid, p);
+}
+
+GOA_JSON_TARGET_AVX512 inline const char *skipWhiteSpace(const char *p,
+                                                         const char *end) {
+  for (; p < end; p += 64) {
+    __mmask64 valid;
+    __m512i v = load(p, end, valid);
+    __mmask64 space = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(' ')) |
+                      _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\t')) |
+                      _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\n')) |
+                      _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\r'));
+    __mmask64 mask = ~space & valid;
+    if (mask != 0) return p + __builtin_ctzll(mask);
+  }
+  return end;
+}
+
+GOA_JSON_TARGET_AVX512 inline const char *scanString(const char *p,
+                                                     const char *end) {
+  for (; p < end; p += 64) {
+    __mmask64 valid;
+    __m512i v = load(p, end, valid);
+    __mmask64 mask = (_mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('"')) |
+                      _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\\')) |
+                      _mm512_cmple_epu8_mask(v, _mm512_set1_epi8(0x1f))) &
+                     valid;
+    if (mask != 0) return p + __builtin_ctzll(mask);
+  }
+  return end;
+}
+
+GOA_JSON_TARGET_AVX512 inline const char *skipDigits(const char *p,
+                                                     const char *end) {
+  for (; p < end; p += 64) {
+    __mmask64 valid;
+    __m512i v = load(p, end, valid);
+    __m512i d = _mm512_sub_epi8(v, _mm512_set1_epi8('0'));
+    __mmask64 mask =
+        ~_mm512_cmple_epu8_mask(d, _mm512_set1_epi8(9)) & valid;
+    if (mask != 0) return p + __builtin_ctzll(mask);
+  }
+  return end;
+}
+
+GOA_JSON_TARGET_AVX512 inline __m512i lookup(const uint8_t *table,
+                                             __m512i index) {
+  __m512i t = _mm512_zextsi128_si512(
+      _mm_load_si128(reinterpret_cast<const __m128i *>(table)));
+  // 复制到每个128位 shuffle_epi8只在128位之内查表
+  // 用maskz形式 GCC对不带掩码的形式误报未初始化
+  t = _mm512_maskz_shuffle_i64x2(0xff, t, t, 0);
+  return _mm512_shuffle_epi8(t, index);
+}
+
+// 与sse42::utf8Errors相同 prev为前64个字节
+GOA_JSON_TARGET_AVX512 inline __m512i utf8Errors(__m512i v, __m512i prev) {
+  const __m512i low4 = _mm512_set1_epi8(0x0f);
+  // 每个128位取其前面的128位 最低的128位取prev的最高128位
+  __m512i shifted = _mm512_permutex2var_epi64(
+      prev, _mm512_set_epi64(13, 12, 11, 10, 9, 8, 7, 6), v);
+  __m512i prev1 = _mm512_alignr_epi8(v, shifted, 15);
+  __m512i prev2 = _mm512_alignr_epi8(v, shifted, 14);
+  __m512i prev3 = _mm512_alignr_epi8(v, shifted, 13);
+  __m512i special = _mm512_and_si512(
+      _mm512_and_si512(
+          lookup(utf8::kByte1High,
+                 _mm512_and_si512(_mm512_srli_epi16(prev1, 4), low4)),
+          lookup(utf8::kByte1Low, _mm512_and_si512(prev1, low4))),
+      lookup(utf8::kByte2High,
+             _mm512_and_si512(_mm512_srli_epi16(v, 4), low4)));
+  __m512i third = _mm512_subs_epu8(prev2, _mm512_set1_epi8(0xe0 - 0x80));
+  __m512i fourth = _mm512_subs_epu8(prev3, _mm512_set1_epi8(0xf0 - 0x80));
+  __m512i must23 = _mm512_and_si512(_mm512_or_si512(third, fourth),
+                                    _mm512_set1_epi8(static_cast<char>(0x80)));
+  return _mm512_xor_si512(must23, special);
+}
+
+// 末尾不足64字节时 被屏蔽的字节为0 被截断的字符在该处报错
+GOA_JSON_TARGET_AVX512 inline const char *scanStringUtf8(const char *p,
+                                                         const char *end) {
+  const char *begin = p;
+  __m512i prev = _mm512_setzero_si512();
+  bool prevAscii = true;
+  for (; p < end; p += 64) {
+    __mmask64 valid;
+    __m512i v = load(p, end, valid);
+    __mmask64 special = (_mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('"')) |
+                         _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\\')) |
+                         _mm512_cmple_epu8_mask(v, _mm512_set1_epi8(0x1f))) &
+                        valid;
+    bool ascii = _mm512_movepi8_mask(v) == 0;
+    __mmask64 errors = 0;
+    if (!ascii || !prevAscii) {
+      __m512i e = utf8Errors(v, prev);
+      errors = _mm512_test_epi8_mask(e, e);
+    }
+    if ((special | errors) != 0) {
+      if (special != 0 && (errors & (special ^ (special - 1))) == 0)
+        return p + __builtin_ctzll(special);
+      return scalar::scanStringUtf8(scalar::utf8Restart(begin, p), end);
+    }
+    prev = v;
+    prevAscii = ascii;
+  }
+  if (!prevAscii)
+    return scalar::scanStringUtf8(scalar::utf8Restart(begin, end), end);
+  return end;
+}
+
+GOA_JSON_TARGET_AVX512 inline CharClassMasks classify(const char *p) {
+  __m512i v = _mm512_loadu_si512(p);
+  __m512i lower = _mm512_or_si512(v, _mm512_set1_epi8(0x20));
+
+  CharClassMasks masks;
+  masks.quote = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('"'));
+  masks.backslash = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\\'));
+  masks.op = _mm512_cmpeq_epi8_mask(lower, _mm512_set1_epi8('{')) |
+             _mm512_cmpeq_epi8_mask(lower, _mm512_set1_epi8('}')) |
+             _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(':')) |
+             _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(','));
+  masks.space = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(' ')) |
+                _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\t')) |
+                _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\n')) |
+                _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\r'));
+  masks.control = _mm512_cmple_epu8_mask(v, _mm512_set1_epi8(0x1f));
+  return masks;
+}
+
+}  // namespace avx512
+
+#undef GOA_JSON_TARGET_SSE42
+#undef GOA_JSON_TARGET_AVX2
+#undef GOA_JSON_TARGET_AVX512
+
+#endif  // GOA_JSON_X86
+
+// 当前CPU支持的最宽指令集
+inline SimdLevel detectSimdLevel() {
+#if defined(GOA_JSON_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+    return SimdLevel::AVX512;
+  if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+  if (__builtin_cpu_supports("sse4.2")) return SimdLevel::SSE42;
+#endif
+  return SimdLevel::SCALAR;
+}
+
+// 调用方需保证level不超过detectSimdLevel()的结果
+inline Kernels getKernels(SimdLevel level) {
+  switch (level) {
+#if defined(GOA_JSON_X86)
+    case SimdLevel::AVX512:
+      return {level, "avx512", avx512::skipWhiteSpace, avx512::scanString,
+              avx512::scanStringUtf8, avx512::skipDigits, avx512::classify};
+    case SimdLevel::AVX2:
+      return {level, "avx2", avx2::skipWhiteSpace, avx2::scanString,
+              avx2::scanStringUtf8, avx2::skipDigits, avx2::classify};
+    case SimdLevel::SSE42:
+      return {level, "sse4.2", sse42::skipWhiteSpace, sse42::scanString,
+              sse42::scanStringUtf8, sse42::skipDigits, sse42::classify};
+#endif
+    default:
+      return {SimdLevel::SCALAR, "scalar", scalar::skipWhiteSpace,
+              scalar::scanString, scalar::scanStringUtf8, scalar::skipDigits,
+              scalar::classify};
+  }
+}
+
+// 全局唯一的内核表 首次调用时完成CPUID检测
+inline const Kernels &kernels() {
+  static const Kernels k = getKernels(detectSimdLevel());
+  return k;
+}
+
+}  // namespace simd
+
+}  // namespace json
+
+}  // namespace goa
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <unordered_map>
+
+#include "Value.hpp"
+#include "noncopyable.hpp"
+
+namespace goa {
+
+namespace json {
+
+/*
+字符串池 相同内容的字符串只分配一次 之后返回共享同一引用计数节点的拷贝
+Document解析时用它对key和短字符串值去重 大量重复的key不再各自分配内存
+
+- 池在一次解析期间有效即可 Value自己持有引用 池销毁后照常可用
+- 同一个池可供多个Document先后使用 相同的字符串在文档之间也共享
+- 池本身不是线程安全的 不能同时用于多个线程中的解析
+- 超过maxLength的字符串很少重复 直接分配 不进入池
+- 短字符串存放在Value内 本就不分配内存 也不进入池
+- 节点从resource分配 使用policy指定的引用计数方式 与Value的构造函数相同
+  resource须比池及其返回的Value活得久
+*/
+class StringPool : noncopyable {
+ public:
+  static constexpr size_t kDefaultMaxLength = 64;
+
+  explicit StringPool(size_t maxLength = kDefaultMaxLength,
+                      std::pmr::memory_resource *resource = nullptr,
+                      RefCountPolicy policy = RefCountPolicy::ATOMIC)
+      : maxLength_(maxLength), resource_(resource), policy_(policy) {
+    strings_.reserve(1024);  // 避免解析途中反复rehash
+  }
+
+  std::pmr::memory_resource *getMemoryResource() const { return resource_; }
+  RefCountPolicy getRefCountPolicy() const { return policy_; }
+
+  Value intern(std::string_view s) {
+    if (s.size() <= Value::kInlineCapacity || s.size() > maxLength_)
+      return Value(s, resource_, policy_);
+    auto it = strings_.find(s);
+    if (it != strings_.end()) {
+      hits_++;
+      savedBytes_ += s.size();
+      return it->second;
+    }
+    // map的key指向池中Value自己的数据 节点不释放 指针始终有效
+    Value value(s, resource_, policy_);
+    strings_.emplace(value.getStringView(), value);
+    return value;
+  }
+
+  // 池中不同字符串的个数
+  size_t getSize() const { return strings_.size(); }
+  // 复用已有节点的次数 及因此少拷贝的字节数
+  size_t getHits() const { return hits_; }
+  size_t getSavedBytes() const { return savedBytes_; }
+
+  void clear() {
+    strings_.clear();
+    hits_ = 0;
+    savedBytes_ = 0;
+  }
+
+ private:
+  const size_t maxLength_;
+  std::pmr::memory_resource *const resource_;
+  const RefCountPolicy policy_;
+  std::unordered_map<std::string_view, Value> strings_;
+  size_t hits_ = 0;
+  size_t savedBytes_ = 0;
+};
+
+}  // namespace json
+
+}  // namespace goa
@@ -25,6 +25,15 @@ class StringReadStream : noncopyable {
     next();
   }
 
+  // 批量访问接口 返回尚未读取的连续字节 配合skip一次跳过多个字节
+  std::string_view getRemaining() const {
+    return json_.substr(static_cast<size_t>(iter_ - json_.begin()));
+  }
+  void skip(size_t n) {
+    assert(n <= static_cast<size_t>(json_.end() - iter_));
+    iter_ += n;
+  }
+
  private:
   const std::string_view json_;
   ConstIterator iter_;
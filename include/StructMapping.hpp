@@ -0,0 +1,438 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "Exception.hpp"
+#include "Reader.hpp"
+#include "StringReadStream.hpp"
+#include "noncopyable.hpp"
+
+/*
+结构体与json对象之间的映射 解析时直接填充结构体 输出时直接产生事件
+两个方向都不构造Document
+
+在结构体所在的命名空间中用GOA_JSON_FIELDS列出成员 json中的key与成员名相同:
+  struct Sku { std::string title; int64_t skuId; };
+  struct Item {
+    int id;
+    std::vector<std::string> tags;
+    std::optional<Sku> sku;
+  };
+  GOA_JSON_FIELDS(Sku, title, skuId)
+  GOA_JSON_FIELDS(Item, id, tags, sku)
+
+key与成员名不同时 在同一命名空间中手写宏所生成的函数:
+  constexpr auto goaJsonFields(const Item *) {
+    return std::make_tuple(goa::json::field("item_id", &Item::id), ...);
+  }
+*/
+#define GOA_JSON_FIELDS(Type, ...)                                \
+  constexpr auto goaJsonFields(const Type *) {                    \
+    return std::make_tuple(GOA_JSON_FOR_EACH(Type, __VA_ARGS__)); \
+  }
+
+// 以下供GOA_JSON_FIELDS展开 最多32个成员
+#define GOA_JSON_F1(T, x) ::goa::json::field(#x, &T::x)
+#define GOA_JSON_F2(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F1(T, __VA_ARGS__)
+#define GOA_JSON_F3(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F2(T, __VA_ARGS__)
+#define GOA_JSON_F4(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F3(T, __VA_ARGS__)
+#define GOA_JSON_F5(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F4(T, __VA_ARGS__)
+#define GOA_JSON_F6(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F5(T, __VA_ARGS__)
+#define GOA_JSON_F7(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F6(T, __VA_ARGS__)
+#define GOA_JSON_F8(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F7(T, __VA_ARGS__)
+#define GOA_JSON_F9(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F8(T, __VA_ARGS__)
+#define GOA_JSON_F10(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F9(T, __VA_ARGS__)
+#define GOA_JSON_F11(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F10(T, __VA_ARGS__)
+#define GOA_JSON_F12(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F11(T, __VA_ARGS__)
+#define GOA_JSON_F13(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F12(T, __VA_ARGS__)
+#define GOA_JSON_F14(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F13(T, __VA_ARGS__)
+#define GOA_JSON_F15(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F14(T, __VA_ARGS__)
+#define GOA_JSON_F16(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F15(T, __VA_ARGS__)
+#define GOA_JSON_F17(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F16(T, __VA_ARGS__)
+#define GOA_JSON_F18(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F17(T, __VA_ARGS__)
+#define GOA_JSON_F19(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F18(T, __VA_ARGS__)
+#define GOA_JSON_F20(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F19(T, __VA_ARGS__)
+#define GOA_JSON_F21(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F20(T, __VA_ARGS__)
+#define GOA_JSON_F22(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F21(T, __VA_ARGS__)
+#define GOA_JSON_F23(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F22(T, __VA_ARGS__)
+#define GOA_JSON_F24(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F23(T, __VA_ARGS__)
+#define GOA_JSON_F25(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F24(T, __VA_ARGS__)
+#define GOA_JSON_F26(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F25(T, __VA_ARGS__)
+#define GOA_JSON_F27(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F26(T, __VA_ARGS__)
+#define GOA_JSON_F28(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F27(T, __VA_ARGS__)
+#define GOA_JSON_F29(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F28(T, __VA_ARGS__)
+#define GOA_JSON_F30(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F29(T, __VA_ARGS__)
+#define GOA_JSON_F31(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F30(T, __VA_ARGS__)
+#define GOA_JSON_F32(T, x, ...) GOA_JSON_F1(T, x), GOA_JSON_F31(T, __VA_ARGS__)
+#define GOA_JSON_SELECT(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12,  \
+                        _13, _14, _15, _16, _17, _18, _19, _20, _21, _22,   \
+                        _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, F, \
+                        ...)                                                 \
+  F
+#define GOA_JSON_FOR_EACH(T, ...)                                          \
+  GOA_JSON_SELECT(__VA_ARGS__, GOA_JSON_F32, GOA_JSON_F31, GOA_JSON_F30,   \
+                  GOA_JSON_F29, GOA_JSON_F28, GOA_JSON_F27, GOA_JSON_F26,  \
+                  GOA_JSON_F25, GOA_JSON_F24, GOA_JSON_F23, GOA_JSON_F22,  \
+                  GOA_JSON_F21, GOA_JSON_F20, GOA_JSON_F19, GOA_JSON_F18,  \
+                  GOA_JSON_F17, GOA_JSON_F16, GOA_JSON_F15, GOA_JSON_F14,  \
+                  GOA_JSON_F13, GOA_JSON_F12, GOA_JSON_F11, GOA_JSON_F10,  \
+                  GOA_JSON_F9, GOA_JSON_F8, GOA_JSON_F7, GOA_JSON_F6,      \
+                  GOA_JSON_F5, GOA_JSON_F4, GOA_JSON_F3, GOA_JSON_F2,      \
+                  GOA_JSON_F1)(T, __VA_ARGS__)
+
+namespace goa {
+
+namespace json {
+
+// 结构体的一个成员 name为json中的key
+template <typename Class, typename Member>
+struct Field {
+  std::string_view name;
+  Member Class::*member;
+};
+
+template <typename Class, typename Member>
+constexpr Field<Class, Member> field(std::string_view name,
+                                     Member Class::*member) {
+  return {name, member};
+}
+
+// 声明了成员的结构体 goaJsonFields由ADL在结构体所在的命名空间中找到
+template <typename T, typename = void>
+inline constexpr bool isMapped = false;
+template <typename T>
+inline constexpr bool isMapped<
+    T, std::void_t<decltype(goaJsonFields(static_cast<const T *>(nullptr)))>> =
+    true;
+
+// 结构体的全部成员 为Field组成的tuple
+template <typename T>
+inline constexpr auto structFields =
+    goaJsonFields(static_cast<const T *>(nullptr));
+
+template <typename T>
+inline constexpr bool isOptional = false;
+template <typename T>
+inline constexpr bool isOptional<std::optional<T>> = true;
+
+template <typename T>
+inline constexpr bool isVector = false;
+template <typename T, typename Alloc>
+inline constexpr bool isVector<std::vector<T, Alloc>> = true;
+
+namespace mapping {
+
+struct Binding;
+
+// 类型擦除后的填充目标
+struct Target {
+  void *object;
+  const Binding *binding;
+};
+
+// 按对象的实际类型填充它的一组函数 该类型不接受的事件对应的函数为空
+struct Binding {
+  Target (*emplace)(void *);  // std::optional收到非null的值时先构造其中的值
+  bool (*null)(void *);
+  bool (*boolean)(void *, bool);
+  bool (*integer)(void *, int64_t);
+  bool (*number)(void *, double);
+  bool (*string)(void *, std::string_view);
+  Target (*field)(void *, std::string_view);  // 未知的key返回空的Target
+  void (*clear)(void *);
+  Target (*element)(void *);  // 在vector末尾添加一个元素
+};
+
+template <typename T>
+const Binding *bindingOf();
+
+template <typename T>
+Target targetOf(T &object) {
+  return Target{&object, bindingOf<T>()};
+}
+
+template <typename T>
+Target emplaceOptional(void *object) {
+  auto &optional = *static_cast<T *>(object);
+  optional.emplace();
+  return targetOf(*optional);
+}
+
+template <typename T>
+bool resetOptional(void *object) {
+  static_cast<T *>(object)->reset();
+  return true;
+}
+
+template <typename T>
+bool setBool(void *object, bool b) {
+  *static_cast<T *>(object) = b;
+  return true;
+}
+
+// 超出T的范围时失败
+template <typename T>
+bool setInteger(void *object, int64_t i) {
+  auto value = static_cast<T>(i);
+  if constexpr (std::is_integral_v<T>) {
+    if ((std::is_unsigned_v<T> && i < 0) || static_cast<int64_t>(value) != i)
+      return false;
+  }
+  *static_cast<T *>(object) = value;
+  return true;
+}
+
+template <typename T>
+bool setNumber(void *object, double d) {
+  *static_cast<T *>(object) = static_cast<T>(d);
+  return true;
+}
+
+template <typename T>
+bool setString(void *object, std::string_view s) {
+  static_cast<T *>(object)->assign(s.data(), s.size());
+  return true;
+}
+
+template <typename T>
+Target findField(void *object, std::string_view key) {
+  auto &s = *static_cast<T *>(object);
+  Target target{nullptr, nullptr};
+  std::apply(
+      [&](const auto &... fields) {
+        ((fields.name == key && (target = targetOf(s.*fields.member), true)) ||
+         ...);
+      },
+      structFields<T>);
+  return target;
+}
+
+template <typename T>
+void clearVector(void *object) {
+  static_cast<T *>(object)->clear();
+}
+
+template <typename T>
+Target addElement(void *object) {
+  auto &vector = *static_cast<T *>(object);
+  vector.emplace_back();
+  return targetOf(vector.back());
+}
+
+template <typename T>
+constexpr Binding makeBinding() {
+  Binding binding{};
+  if constexpr (isOptional<T>) {
+    binding.emplace = emplaceOptional<T>;
+    binding.null = resetOptional<T>;
+  } else if constexpr (std::is_same_v<T, bool>) {
+    binding.boolean = setBool<T>;
+  } else if constexpr (std::is_arithmetic_v<T>) {
+    binding.integer = setInteger<T>;
+    if constexpr (std::is_floating_point_v<T>) binding.number = setNumber<T>;
+  } else if constexpr (std::is_same_v<T, std::string>) {
+    binding.string = setString<T>;
+  } else if constexpr (isVector<T>) {
+    static_assert(!std::is_same_v<typename T::value_type, bool>,
+                  "std::vector<bool> is not supported");
+    binding.clear = clearVector<T>;
+    binding.element = addElement<T>;
+  } else {
+    static_assert(isMapped<T>, "declare the fields with GOA_JSON_FIELDS");
+    binding.field = findField<T>;
+  }
+  return binding;
+}
+
+template <typename T>
+const Binding *bindingOf() {
+  static constexpr Binding binding = makeBinding<T>();
+  return &binding;
+}
+
+}  // namespace mapping
+
+/*
+把解析事件直接填入T类型的对象 不构造任何Value
+T可以是声明了成员的结构体 也可以是下列类型及其组合:
+bool、整数、浮点数、std::string、std::vector、std::optional
+
+- 整数可填入整数和浮点数 超出成员类型的范围时失败 浮点数只能填入浮点数
+- null只能填入std::optional 数组会覆盖vector中原有的元素
+- json中没有出现的成员保持原值 未知的key连同其值一起跳过
+  Reader通过skipValue得知这样的值 只检查其语法 不解码字符串和数字
+类型不匹配时返回false 解析结果为PARSE_USER_STOPPED
+*/
+template <typename T>
+class StructHandler : noncopyable {
+ public:
+  explicit StructHandler(T &object) : root_(mapping::targetOf(object)) {}
+
+  bool Null() {
+    if (skipped_ != 0) return true;
+    mapping::Target target = next();
+    if (target.object == nullptr) return true;
+    return target.binding->null != nullptr &&
+           target.binding->null(target.object);
+  }
+  bool Bool(bool b) { return set(&mapping::Binding::boolean, b); }
+  bool Int32(int32_t i32) { return set(&mapping::Binding::integer, i32); }
+  bool Int64(int64_t i64) { return set(&mapping::Binding::integer, i64); }
+  bool Double(double d) { return set(&mapping::Binding::number, d); }
+  bool String(std::string_view s) { return set(&mapping::Binding::string, s); }
+
+  bool StartObject() {
+    if (skipped_ == 0) {
+      mapping::Target target = nextValue();
+      if (target.object != nullptr) {
+        if (target.binding->field == nullptr) return false;
+        stack_.push_back(Level{target, false});
+        return true;
+      }
+    }
+    skipped_++;
+    return true;
+  }
+  bool Key(std::string_view key) {
+    if (skipped_ == 0) {
+      mapping::Target &object = stack_.back().target;
+      key_ = object.binding->field(object.object, key);
+    }
+    return true;
+  }
+  bool EndObject() { return end(); }
+  // 当前key没有对应的成员
+  bool skipValue() const { return skipped_ == 0 && key_.object == nullptr; }
+
+  bool StartArray() {
+    if (skipped_ == 0) {
+      mapping::Target target = nextValue();
+      if (target.object != nullptr) {
+        if (target.binding->element == nullptr) return false;
+        target.binding->clear(target.object);
+        stack_.push_back(Level{target, true});
+        return true;
+      }
+    }
+    skipped_++;
+    return true;
+  }
+  bool EndArray() { return end(); }
+
+ private:
+  struct Level {
+    mapping::Target target;  // 正在填充的结构体或vector
+    bool inArray;
+  };
+
+  // 下一个值的填充目标 未知key的值返回空的Target
+  mapping::Target next() {
+    if (stack_.empty()) return root_;
+    Level &top = stack_.back();
+    if (top.inArray) return top.target.binding->element(top.target.object);
+    return key_;
+  }
+
+  // 非null的值 先构造std::optional中的值
+  mapping::Target nextValue() {
+    mapping::Target target = next();
+    while (target.object != nullptr && target.binding->emplace != nullptr)
+      target = target.binding->emplace(target.object);
+    return target;
+  }
+
+  template <typename Setter, typename V>
+  bool set(Setter mapping::Binding::*setter, V v) {
+    if (skipped_ != 0) return true;
+    mapping::Target target = nextValue();
+    if (target.object == nullptr) return true;
+    Setter fn = target.binding->*setter;
+    return fn != nullptr && fn(target.object, v);
+  }
+
+  bool end() {
+    if (skipped_ != 0)
+      skipped_--;
+    else
+      stack_.pop_back();
+    return true;
+  }
+
+  mapping::Target root_;
+  mapping::Target key_{nullptr, nullptr};  // 当前key对应的成员
+  std::vector<Level> stack_;
+  // 正在跳过的容器的层数 事件来自不询问skipValue的handler调用方时使用
+  size_t skipped_ = 0;
+};
+
+// 把json解析到object中 Flags见Reader
+template <unsigned Flags = kParseDefaultFlags, typename ReadStream, typename T,
+          typename = std::enable_if_t<isReadStream<ReadStream>>>
+ParseResult parseStruct(ReadStream &is, T &object) {
+  StructHandler<T> handler(object);
+  return Reader::parse<Flags>(is, handler);
+}
+
+template <unsigned Flags = kParseDefaultFlags, typename T>
+ParseResult parseStruct(std::string_view json, T &object) {
+  StringReadStream is(json);
+  return parseStruct<Flags>(is, object);
+}
+
+/*
+按同一映射把object作为事件发给handler 不构造任何Value
+handler通常为Writer 也可以是Document等其他handler 成员按声明的顺序输出
+std::optional为空时输出null 整数在int32_t范围内时输出Int32 否则输出Int64
+handler返回false时停止并返回false
+*/
+template <typename Handler, typename T>
+bool writeStruct(Handler &handler, const T &object) {
+  if constexpr (isOptional<T>) {
+    return object.has_value() ? writeStruct(handler, *object) : handler.Null();
+  } else if constexpr (std::is_same_v<T, bool>) {
+    return handler.Bool(object);
+  } else if constexpr (std::is_integral_v<T>) {
+    assert(std::is_signed_v<T> || sizeof(T) < sizeof(int64_t) ||
+           object <= static_cast<T>(std::numeric_limits<int64_t>::max()));
+    auto i = static_cast<int64_t>(object);
+    if (i >= std::numeric_limits<int32_t>::min() &&
+        i <= std::numeric_limits<int32_t>::max())
+      return handler.Int32(static_cast<int32_t>(i));
+    return handler.Int64(i);
+  } else if constexpr (std::is_floating_point_v<T>) {
+    return handler.Double(static_cast<double>(object));
+  } else if constexpr (std::is_same_v<T, std::string>) {
+    return handler.String(object);
+  } else if constexpr (isVector<T>) {
+    static_assert(!std::is_same_v<typename T::value_type, bool>,
+                  "std::vector<bool> is not supported");
+    if (!handler.StartArray()) return false;
+    for (auto &element : object)
+      if (!writeStruct(handler, element)) return false;
+    return handler.EndArray();
+  } else {
+    static_assert(isMapped<T>, "declare the fields with GOA_JSON_FIELDS");
+    // key在编译期确定 直接传给handler 不经过任何临时的字符串
+    return handler.StartObject() &&
+           std::apply(
+               [&](const auto &... fields) {
+                 return ((handler.Key(fields.name) &&
+                          writeStruct(handler, object.*fields.member)) &&
+                         ...);
+               },
+               structFields<T>) &&
+           handler.EndObject();
+  }
+}
+
+}  // namespace json
+
+}  // namespace goa
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+#include "SimdKernels.hpp"
+#include "noncopyable.hpp"
+
+namespace goa {
+
+namespace json {
+
+/*
+以64字节为一块 跨块追踪反斜杠转义和字符串区间
+StructuralIndex和按需解析(OnDemand.hpp)跳过嵌套值时共用
+调用方需保证第一块的起点位于字符串之外
+*/
+class StringTracker {
+ public:
+  struct Masks {
+    uint64_t quote;     // 未被转义的引号
+    uint64_t inString;  // 从左引号(含)到右引号(不含)的字符串区间
+  };
+
+  inline Masks next(const simd::CharClassMasks &block);
+
+ private:
+  static inline uint64_t prefixXor(uint64_t x);
+
+  uint64_t prevEscaped_ = 0;   // 上一块末尾是否以未配对的反斜杠结束
+  uint64_t prevInString_ = 0;  // 上一块末尾是否处于字符串内 全0或全1
+};
+
+/*
+两阶段解析的第一阶段：结构索引
+以64字节为一块 用SIMD内核(见SimdKernels.hpp)一次性对整块字符分类 得到若干64位掩码
+(每一位对应块内一个字节) 再用位运算求出：
+1. 字符串外的结构字符 { } [ ] : ,
+2. 所有未被转义的引号 (字符串的起止位置)
+3. 字符串外标量(数字 true false null等)的起始位置
+这些位置按顺序记录在positions_中 第二阶段(StructuralReader)只需在这些位置间跳转
+两个相邻位置之间只可能是空白、字符串内容或标量本身 无需再逐字节判断
+另外按块记录字符串中是否出现反斜杠或控制字符 其余字符串第二阶段无需再扫描
+*/
+class StructuralIndex : noncopyable {
+ public:
+  StructuralIndex() = default;
+
+  // 位置使用uint32_t保存 输入不得超过4GB
+  static bool canIndex(std::string_view json) {
+    return json.size() < std::numeric_limits<uint32_t>::max();
+  }
+
+  void build(std::string_view json) {
+    assert(canIndex(json));
+    positions_.clear();
+    count_ = 0;
+    size_t blocks = (json.size() + 63) / 64;
+    escapedBlocks_.assign((blocks + 63) / 64, 0);
+
+    auto classify = simd::kernels().classify;
+    State state;
+    size_t i = 0;
+    for (; i + 64 <= json.size(); i += 64)
+      indexBlock(classify(json.data() + i), i, state);
+
+    // 末尾不足64字节的部分 以空白补齐 空白不会产生任何结构位置
+    if (i < json.size()) {
+      char tail[64];
+      std::memset(tail, ' ', sizeof(tail));
+      std::memcpy(tail, json.data() + i, json.size() - i);
+      indexBlock(classify(tail), i, state);
+    }
+    positions_.resize(count_);
+  }
+
+  const std::vector<uint32_t> &getPositions() const { return positions_; }
+  size_t size() const { return positions_.size(); }
+
+  // open和close为一对引号的位置 其间的字符串不含反斜杠和控制字符时返回true
+  // 按块判断 同一块中其他字符串含有这些字符时也返回false
+  bool isPlainString(size_t open, size_t close) const {
+    for (size_t b = open / 64; b <= close / 64; b++)
+      if (escapedBlocks_[b / 64] >> (b % 64) & 1) return false;
+    return true;
+  }
+
+ private:
+  // 跨块传递的状态
+  struct State {
+    StringTracker strings;
+    uint64_t prevScalar = 0;  // 上一块最后一个字节是否属于标量
+  };
+
+  inline void indexBlock(const simd::CharClassMasks &block, size_t base,
+                         State &state);
+
+ private:
+  std::vector<uint32_t> positions_;
+  size_t count_ = 0;
+  std::vector<uint64_t> escapedBlocks_;  // 每块一位 见isPlainString
+};
+
+// 前缀异或：结果的第i位为x第0~i位的异或
+// 对引号掩码求前缀异或 即得到从左引号(含)到右引号(不含)的字符串区间
+inline uint64_t StringTracker::prefixXor(uint64_t x) {
+  x ^= x << 1;
+  x ^= x << 2;
+  x ^= x << 4;
+  x ^= x << 8;
+  x ^= x << 16;
+  x ^= x << 32;
+  return x;
+}
+
+inline StringTracker::Masks StringTracker::next(
+    const simd::CharClassMasks &block) {
+  // 1. 找出被转义的字符
+  // 连续的反斜杠中 只有奇数长度的序列会转义其后的字符
+  // 做法来自simdjson: 利用加法进位区分从奇数位和偶数位开始的反斜杠序列
+  const uint64_t evenBits = 0x5555555555555555ULL;
+  uint64_t backslash = block.backslash & ~prevEscaped_;
+  uint64_t followsEscape = backslash << 1 | prevEscaped_;
+  uint64_t oddSequenceStarts = backslash & ~evenBits & ~followsEscape;
+  uint64_t sequencesStartingOnEvenBits;
+  prevEscaped_ = __builtin_add_overflow(oddSequenceStarts, backslash,
+                                        &sequencesStartingOnEvenBits)
+                     ? 1
+                     : 0;
+  uint64_t invertMask = sequencesStartingOnEvenBits << 1;
+  uint64_t escaped = (evenBits ^ invertMask) & followsEscape;
+
+  // 2. 未转义的引号 及字符串区间
+  uint64_t quote = block.quote & ~escaped;
+  uint64_t inString = prefixXor(quote) ^ prevInString_;
+  prevInString_ = uint64_t(0) - (inString >> 63);
+  return {quote, inString};
+}
+
+inline void StructuralIndex::indexBlock(const simd::CharClassMasks &block,
+                                        size_t base, State &state) {
+  auto [quote, inString] = state.strings.next(block);
+
+  // 字符串外的标量起始位置: 标量字节的前一个字节不是标量
+  uint64_t scalar = ~(block.op | block.space | quote) & ~inString;
+  uint64_t scalarStart = scalar & ~(scalar << 1 | state.prevScalar);
+  state.prevScalar = scalar >> 63;
+
+  uint64_t structurals = (block.op & ~inString) | quote | scalarStart;
+  if (((block.backslash | block.control) & inString) != 0)
+    escapedBlocks_[base / 4096] |= uint64_t(1) << (base / 64 % 64);
+
+  if (count_ + 64 > positions_.size())
+    positions_.resize(std::max(positions_.size() * 2, count_ + 64));
+  uint32_t *out = positions_.data() + count_;
+  while (structurals != 0) {
+    *out++ = static_cast<uint32_t>(base) +
+             static_cast<uint32_t>(__builtin_ctzll(structurals));
+    structurals &= structurals - 1;
+  }
+  count_ = static_cast<size_t>(out - positions_.data());
+}
+
+}  // namespace json
+
+}  // namespace goa
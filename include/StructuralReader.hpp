@@ -0,0 +1,264 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "Exception.hpp"
+#include "Reader.hpp"
+#include "SimdKernels.hpp"
+#include "StringReadStream.hpp"
+#include "StructuralIndex.hpp"
+
+namespace goa {
+
+namespace json {
+
+/*
+两阶段解析器 仅接受StringReadStream
+第一阶段用StructuralIndex以SIMD一次性建立结构字符索引
+第二阶段按索引顺序遍历 向handler发送与Reader完全相同的事件、错误码和偏移量:
+- 空白、冒号和逗号的位置都已在索引中 不再逐字节判断
+- 不含转义的字符串已由第一阶段确认 直接以指向输入的string_view交给handler
+- 其余字符串和标量由Reader中对应的函数直接从索引所指的位置解码
+- 层级记录在ParseStack中 不做递归 嵌套深度的限制与Reader相同
+*/
+class StructuralReader : noncopyable {
+ public:
+  template <unsigned Flags = kParseDefaultFlags, typename Handler>
+  static ParseResult parse(StringReadStream &is, Handler &handler) {
+    StructuralIndex index;
+    return parse<Flags>(is, handler, index);
+  }
+
+  // 可复用同一个index 多次解析时避免重复分配索引空间
+  // 与Reader相同 每个线程复用同一个ParseStack
+  template <unsigned Flags = kParseDefaultFlags, typename Handler>
+  static ParseResult parse(StringReadStream &is, Handler &handler,
+                           StructuralIndex &index) {
+    static thread_local ParseStack cached;
+    if (cached.busy_) {
+      ParseStack stack;
+      return parse<Flags>(is, handler, index, stack);
+    }
+    return parse<Flags>(is, handler, index, cached);
+  }
+
+  // 嵌套深度的限制取自stack 出错时is与Reader一样停在出错的位置
+  template <unsigned Flags = kParseDefaultFlags, typename Handler>
+  static ParseResult parse(StringReadStream &is, Handler &handler,
+                           StructuralIndex &index, ParseStack &stack) {
+    std::string_view json = is.getRemaining();
+    if (!StructuralIndex::canIndex(json))
+      return Reader::parse<Flags>(is, handler, stack);
+
+    ParseStack::BusyGuard guard(stack);
+    stack.levels_.clear();
+    index.build(json);
+    Cursor cursor{json, index, index.getPositions().data(), index.size(), 0,
+                  is};
+    ParseError err = parseValues<Flags>(cursor, handler, stack);
+    if (err == ParseError::PARSE_OK && cursor.k != cursor.n)
+      err = cursor.fail(ParseError::PARSE_ROOT_NOT_SINGULAR);
+    if (err == ParseError::PARSE_OK) cursor.seek(json.size());
+    return ParseResult(err, cursor.offset());
+  }
+
+ private:
+  // 第二阶段的位置: 下一个结构位置positions[k] 以及Reader解码用的输入流
+  // 流只在Reader解码字符串和标量、或出错时向前移动
+  struct Cursor {
+    std::string_view json;
+    const StructuralIndex &index;
+    const uint32_t *positions;
+    size_t n;
+    size_t k;
+    StringReadStream &is;
+
+    char current() const { return k < n ? json[positions[k]] : '\0'; }
+    // 第k个结构位置 没有时为输入末尾
+    size_t position() const { return k < n ? positions[k] : json.size(); }
+    size_t offset() const { return json.size() - is.getRemaining().size(); }
+    void seek(size_t pos) { is.skip(pos - offset()); }
+    // 在当前结构位置报错 Reader在此处遇到同样的字符
+    ParseError fail(ParseError err) {
+      seek(position());
+      return err;
+    }
+  };
+
+// handler中止时 流停在Reader调用handler时所在的位置
+#define CALL(expr, pos)                      \
+  do {                                       \
+    if (!(expr)) {                           \
+      cursor.seek(pos);                      \
+      return ParseError::PARSE_USER_STOPPED; \
+    }                                        \
+  } while (0)
+#define TRY(expr)                                          \
+  do {                                                     \
+    ParseError err_ = (expr);                              \
+    if (__builtin_expect(err_ != ParseError::PARSE_OK, 0)) \
+      return err_;                                         \
+  } while (0)
+
+  enum class State { VALUE, OBJECT_KEY, AFTER_VALUE };
+
+  // 与Reader::parseValues相同的状态机 解析一个完整的值
+  // 回到开始时的层级即结束 其后的内容由调用方检查
+  template <unsigned Flags, typename Handler>
+  static ParseError parseValues(Cursor &cursor, Handler &handler,
+                                ParseStack &stack) {
+    auto &levels = stack.levels_;
+    const size_t base = levels.size();
+    const uint32_t *positions = cursor.positions;
+    State state = State::VALUE;
+
+    while (true) {
+      switch (state) {
+        case State::VALUE:
+          if (cursor.k == cursor.n)
+            return cursor.fail(ParseError::PARSE_EXPECT_VALUE);
+          switch (cursor.current()) {
+            case '{':
+              if (levels.size() >= stack.maxDepth_)
+                return cursor.fail(ParseError::PARSE_DEPTH_EXCEEDED);
+              CALL(handler.StartObject(), positions[cursor.k]);
+              cursor.k++;
+              if (cursor.current() == '}') {
+                cursor.k++;
+                CALL(handler.EndObject(), positions[cursor.k - 1] + 1);
+                state = State::AFTER_VALUE;
+              } else {
+                levels.push_back(ValueType::TYPE_OBJECT);
+                state = State::OBJECT_KEY;
+              }
+              break;
+            case '[':
+              if (levels.size() >= stack.maxDepth_)
+                return cursor.fail(ParseError::PARSE_DEPTH_EXCEEDED);
+              CALL(handler.StartArray(), positions[cursor.k]);
+              cursor.k++;
+              if (cursor.current() == ']') {
+                cursor.k++;
+                CALL(handler.EndArray(), positions[cursor.k - 1] + 1);
+                state = State::AFTER_VALUE;
+              } else {
+                levels.push_back(ValueType::TYPE_ARRAY);
+              }
+              break;
+            case '"':
+              TRY(parseString<Flags>(cursor, handler, false));
+              state = State::AFTER_VALUE;
+              break;
+            default:
+              TRY(parseScalar<Flags>(cursor, handler, levels));
+              state = State::AFTER_VALUE;
+              break;
+          }
+          break;
+
+        case State::OBJECT_KEY:
+          if (cursor.current() != '"')
+            return cursor.fail(ParseError::PARSE_MISS_KEY);
+          TRY(parseString<Flags>(cursor, handler, true));
+          if (cursor.current() != ':')
+            return cursor.fail(ParseError::PARSE_MISS_COLON);
+          cursor.k++;
+          state = State::VALUE;
+          if constexpr (hasSkipValue<Handler>) {
+            if (handler.skipValue()) {
+              Reader::SkipHandler skipper;
+              TRY(parseValues<Flags>(cursor, skipper, stack));
+              state = State::AFTER_VALUE;
+            }
+          }
+          break;
+
+        case State::AFTER_VALUE:
+          if (levels.size() == base) return ParseError::PARSE_OK;
+          if (levels.back() == ValueType::TYPE_ARRAY) {
+            switch (cursor.current()) {
+              case ',':
+                cursor.k++;
+                state = State::VALUE;
+                break;
+              case ']':
+                levels.pop_back();
+                cursor.k++;
+                CALL(handler.EndArray(), positions[cursor.k - 1] + 1);
+                break;
+              default:
+                return cursor.fail(
+                    ParseError::PARSE_MISS_COMMA_OR_SQUARE_BRACKET);
+            }
+          } else {
+            switch (cursor.current()) {
+              case ',':
+                cursor.k++;
+                state = State::OBJECT_KEY;
+                break;
+              case '}':
+                levels.pop_back();
+                cursor.k++;
+                CALL(handler.EndObject(), positions[cursor.k - 1] + 1);
+                break;
+              default:
+                return cursor.fail(
+                    ParseError::PARSE_MISS_COMMA_OR_CURLY_BRACKET);
+            }
+          }
+          break;
+      }
+    }
+  }
+
+  // positions[k]为左引号 字符串闭合时positions[k + 1]为右引号
+  // 第一阶段确认不含转义和控制字符的字符串 直接把两个引号之间交给handler
+  // 其余的交给Reader 未闭合等错误由Reader报告 流停在出错的位置
+  // 校验UTF-8时都交给Reader
+  template <unsigned Flags, typename Handler>
+  static ParseError parseString(Cursor &cursor, Handler &handler,
+                                bool isKey) {
+    size_t open = cursor.positions[cursor.k];
+    if constexpr ((Flags & kParseValidateUtf8Flag) == 0) {
+      if (cursor.k + 1 < cursor.n) {
+        size_t close = cursor.positions[cursor.k + 1];
+        if (cursor.index.isPlainString(open, close)) {
+          cursor.k += 2;
+          std::string_view s = cursor.json.substr(open + 1, close - open - 1);
+          ParseError err = Reader::emitString(handler, s, isKey);
+          if (err != ParseError::PARSE_OK) cursor.seek(close + 1);
+          return err;
+        }
+      }
+    }
+    cursor.seek(open);
+    TRY(Reader::parseString<Flags>(cursor.is, handler, isKey));
+    cursor.k += 2;
+    return ParseError::PARSE_OK;
+  }
+
+  // 标量的字节中没有结构字符和空白 Reader解码时不会越过下一个结构位置
+  // 解码停下的位置若不是空白 就是紧跟在标量之后的多余字符 Reader在这里报错
+  template <unsigned Flags, typename Handler>
+  static ParseError parseScalar(Cursor &cursor, Handler &handler,
+                                const std::vector<ValueType> &levels) {
+    cursor.seek(cursor.positions[cursor.k]);
+    TRY(Reader::parseScalar<Flags>(cursor.is, handler));
+    cursor.k++;
+    size_t end = cursor.offset();
+    if (end == cursor.position() || Reader::isSpace(cursor.json[end]))
+      return ParseError::PARSE_OK;
+    if (levels.empty()) return ParseError::PARSE_ROOT_NOT_SINGULAR;
+    return levels.back() == ValueType::TYPE_ARRAY
+               ? ParseError::PARSE_MISS_COMMA_OR_SQUARE_BRACKET
+               : ParseError::PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+  }
+
+#undef TRY
+#undef CALL
+};
+
+}  // namespace json
+
+}  // namespace goa
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "noncopyable.hpp"
+
+namespace goa {
+
+namespace json {
+
+/*
+并行解析使用的固定大小线程池 只提供parallelFor一种用法
+调用线程也参与计算 因此n个线程的池只创建n-1个工作线程
+任务按下标由各线程从同一个原子计数器领取 较快的线程自然多领 不需要预先均分
+同一时刻只执行一个parallelFor 多个线程同时调用时依次执行
+*/
+class ThreadPool : noncopyable {
+ public:
+  static size_t defaultThreads() {
+    size_t n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+  }
+
+  explicit ThreadPool(size_t threads = defaultThreads()) {
+    for (size_t i = 1; i < threads; i++)
+      workers_.emplace_back([this] { workerLoop(); });
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard lock(mutex_);
+      stop_ = true;
+    }
+    wakeup_.notify_all();
+    for (auto &worker : workers_) worker.join();
+  }
+
+  size_t getThreads() const { return workers_.size() + 1; }
+
+  // 对[0, n)中的每个i调用一次f(i) 全部完成后返回
+  // f在多个线程上并发执行 不能抛出异常
+  template <typename F>
+  void parallelFor(size_t n, F &&f) {
+    if (workers_.empty() || n <= 1) {
+      for (size_t i = 0; i < n; i++) f(i);
+      return;
+    }
+    std::lock_guard call(callMutex_);
+    {
+      std::lock_guard lock(mutex_);
+      using Fn = std::remove_reference_t<F>;
+      task_ = [](void *ctx, size_t i) { (*static_cast<Fn *>(ctx))(i); };
+      ctx_ = const_cast<void *>(static_cast<const void *>(std::addressof(f)));
+      size_ = n;
+      next_ = 0;
+      running_ = workers_.size();
+      generation_++;
+    }
+    wakeup_.notify_all();
+    runTasks(task_, ctx_);
+
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [this] { return running_ == 0; });
+  }
+
+ private:
+  using Task = void (*)(void *, size_t);
+
+  void runTasks(Task task, void *ctx) {
+    size_t i;
+    while ((i = next_.fetch_add(1, std::memory_order_relaxed)) < size_)
+      task(ctx, i);
+  }
+
+  // 每个工作线程对每一轮parallelFor恰好报到一次 即使没有领到任务
+  void workerLoop() {
+    size_t seen = 0;
+    while (true) {
+      Task task;
+      void *ctx;
+      {
+        std::unique_lock lock(mutex_);
+        wakeup_.wait(lock, [&] { return stop_ || generation_ != seen; });
+        if (stop_) return;
+        seen = generation_;
+        task = task_;
+        ctx = ctx_;
+      }
+      runTasks(task, ctx);
+      std::lock_guard lock(mutex_);
+      if (--running_ == 0) done_.notify_one();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+
+  std::mutex callMutex_;  // 串行化并发的parallelFor调用
+  std::mutex mutex_;      // 保护以下的任务描述和计数
+  std::condition_variable wakeup_;
+  std::condition_variable done_;
+  Task task_ = nullptr;
+  void *ctx_ = nullptr;
+  size_t size_ = 0;
+  std::atomic<size_t> next_{0};
+  size_t running_ = 0;  // 尚未完成本轮的工作线程数
+  size_t generation_ = 0;
+  bool stop_ = false;
+};
+
+}  // namespace json
+
+}  // namespace goa
@@ -3,17 +3,22 @@
 #include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <cstring>
+#include <limits>
+#include <memory_resource>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+#include "KeyDictionary.hpp"
 #include "noncopyable.hpp"
 
 namespace goa {
 
 namespace json {
 
-enum class ValueType {
+enum class ValueType : uint8_t {
   TYPE_NULL,
   TYPE_BOOL,
   TYPE_INT32,
@@ -24,6 +29,21 @@ enum class ValueType {
   TYPE_OBJECT
 };
 
+/*
+string array object节点的引用计数方式 创建节点时决定 之后的拷贝都沿用
+- ATOMIC 原子增减 节点及其拷贝可以在线程之间共享
+- LOCAL  普通的读改写 没有加锁指令 节点及从中拷贝出的Value只能在一个线程内使用
+
+默认两种方式可在同一程序中并存 每次增减按节点记录的方式选择
+编译时定义GOA_JSON_REFCOUNT_ATOMIC或GOA_JSON_REFCOUNT_LOCAL(CMake选项
+GOA_JSON_REFCOUNT)则所有节点固定为该方式 忽略构造时传入的policy 增减时不再判断
+*/
+enum class RefCountPolicy : uint8_t { ATOMIC, LOCAL };
+
+#if defined(GOA_JSON_REFCOUNT_ATOMIC) && defined(GOA_JSON_REFCOUNT_LOCAL)
+#error "GOA_JSON_REFCOUNT_ATOMIC and GOA_JSON_REFCOUNT_LOCAL are exclusive"
+#endif
+
 struct Member;
 class Document;
 
@@ -53,75 +73,106 @@ class Value {
   friend Document;
 
  public:
-  using MemberIterator = std::vector<Member>::iterator;
-  using constMemberIterator = std::vector<Member>::const_iterator;
+  using MemberIterator = std::pmr::vector<Member>::iterator;
+  using constMemberIterator = std::pmr::vector<Member>::const_iterator;
+
+  // 不超过该长度的字符串直接存放在Value内 不分配堆内存
+  static constexpr size_t kInlineCapacity = 13;
 
  public:
-  explicit inline Value(ValueType type = ValueType::TYPE_NULL);
-  explicit Value(bool b) : type_(ValueType::TYPE_BOOL), b_(b) {}
-  explicit Value(int32_t i32) : type_(ValueType::TYPE_INT32), i32_(i32) {}
-  explicit Value(int64_t i64) : type_(ValueType::TYPE_INT64), i64_(i64) {}
-  explicit Value(double d) : type_(ValueType::TYPE_DOUBLE), d_(d) {}
-  explicit Value(std::string_view s)
-      : type_(ValueType::TYPE_STRING),
-        s_(new StringWithRefCount(s.begin(), s.end())) {}
-  explicit Value(const char *s)
-      : type_(ValueType::TYPE_STRING),
-        s_(new StringWithRefCount(s, s + strlen(s))) {}
+  // resource为string array object节点及其数据的内存来源 为空时使用new/delete
+  // 如Document的arena 调用方需保证resource比该Value及其所有拷贝活得久
+  explicit inline Value(ValueType type = ValueType::TYPE_NULL,
+                        std::pmr::memory_resource *resource = nullptr,
+                        RefCountPolicy policy = RefCountPolicy::ATOMIC);
+  explicit Value(bool b) {
+    data_.type = ValueType::TYPE_BOOL;
+    data_.b = b;
+  }
+  explicit Value(int32_t i32) {
+    data_.type = ValueType::TYPE_INT32;
+    data_.i32 = i32;
+  }
+  explicit Value(int64_t i64) {
+    data_.type = ValueType::TYPE_INT64;
+    data_.i64 = i64;
+  }
+  explicit Value(double d) {
+    data_.type = ValueType::TYPE_DOUBLE;
+    data_.d = d;
+  }
+  explicit Value(std::string_view s,
+                 std::pmr::memory_resource *resource = nullptr,
+                 RefCountPolicy policy = RefCountPolicy::ATOMIC) {
+    if (s.size() <= kInlineCapacity) {
+      setInline(s);
+    } else {
+      data_.type = ValueType::TYPE_STRING;
+      data_.s =
+          newNode<StringWithRefCount>(resource, policy, s.begin(), s.end());
+    }
+  }
+  explicit Value(const char *s) : Value(std::string_view(s)) {}
   Value(const char *s, size_t len) : Value(std::string_view(s, len)) {}
 
-  inline Value(const Value &);  //拷贝构造函数
-  inline Value(Value &&);       // 移动构造函数
+  // 移动声明为noexcept vector扩容时才会移动元素 而不是逐个拷贝
+  inline Value(const Value &);      //拷贝构造函数
+  inline Value(Value &&) noexcept;  // 移动构造函数
 
-  inline Value &operator=(const Value &);  // 拷贝赋值运算符
-  inline Value &operator=(Value &&);       //移动赋值运算符
+  inline Value &operator=(const Value &);      // 拷贝赋值运算符
+  inline Value &operator=(Value &&) noexcept;  //移动赋值运算符
 
   inline ~Value();
 
  public:
-  ValueType getType() const { return type_; }
+  ValueType getType() const { return data_.type; }
   inline size_t getSize() const;
 
-  bool isNull() const { return type_ == ValueType::TYPE_NULL; }
-  bool isBool() const { return type_ == ValueType::TYPE_BOOL; }
-  bool isInt32() const { return type_ == ValueType::TYPE_INT32; }
+  bool isNull() const { return data_.type == ValueType::TYPE_NULL; }
+  bool isBool() const { return data_.type == ValueType::TYPE_BOOL; }
+  bool isInt32() const { return data_.type == ValueType::TYPE_INT32; }
   bool isInt64() const {
-    return type_ == ValueType::TYPE_INT64 || type_ == ValueType::TYPE_INT32;
+    return data_.type == ValueType::TYPE_INT64 ||
+           data_.type == ValueType::TYPE_INT32;
   }
-  bool isDouble() const { return type_ == ValueType::TYPE_DOUBLE; }
-  bool isString() const { return type_ == ValueType::TYPE_STRING; }
-  bool isArray() const { return type_ == ValueType::TYPE_ARRAY; }
-  bool isObject() const { return type_ == ValueType::TYPE_OBJECT; }
+  bool isDouble() const { return data_.type == ValueType::TYPE_DOUBLE; }
+  bool isString() const { return data_.type == ValueType::TYPE_STRING; }
+  bool isArray() const { return data_.type == ValueType::TYPE_ARRAY; }
+  bool isObject() const { return data_.type == ValueType::TYPE_OBJECT; }
 
   bool getBool() const {
-    assert(type_ == ValueType::TYPE_BOOL);
-    return b_;
+    assert(data_.type == ValueType::TYPE_BOOL);
+    return data_.b;
   }
   int32_t getInt32() const {
-    assert(type_ == ValueType::TYPE_INT32);
-    return i32_;
+    assert(data_.type == ValueType::TYPE_INT32);
+    return data_.i32;
   }
   double getDouble() const {
-    assert(type_ == ValueType::TYPE_DOUBLE);
-    return d_;
+    assert(data_.type == ValueType::TYPE_DOUBLE);
+    return data_.d;
   }
   const auto &getArray() const {
-    assert(type_ == ValueType::TYPE_ARRAY);
-    return a_->data;
+    assert(data_.type == ValueType::TYPE_ARRAY);
+    return data_.a->data;
   }
   const auto &getObject() const {
-    assert(type_ == ValueType::TYPE_OBJECT);
-    return o_->data;
+    assert(data_.type == ValueType::TYPE_OBJECT);
+    return data_.o->data;
   }
   std::string getString() const { return std::string(getStringView()); }
 
   int64_t getInt64() const {
-    assert(type_ == ValueType::TYPE_INT64 || type_ == ValueType::TYPE_INT32);
-    return type_ == ValueType::TYPE_INT64 ? i64_ : i32_;
+    assert(isInt64());
+    return data_.type == ValueType::TYPE_INT64 ? data_.i64 : data_.i32;
   }
   std::string_view getStringView() const {
-    assert(type_ == ValueType::TYPE_STRING);
-    return std::string_view(&*s_->data.begin(), s_->data.size());
+    assert(data_.type == ValueType::TYPE_STRING);
+    if (data_.kind == StringKind::VIEW)
+      return std::string_view(data_.view, data_.viewSize);
+    if (data_.kind == StringKind::INLINE)
+      return std::string_view(inline_.chars, inline_.size);
+    return std::string_view(&*data_.s->data.begin(), data_.s->data.size());
   }
 
   // placement new 用于在已有的内存上构造对象 用法： new (pointer)
@@ -166,20 +217,20 @@ class Value {
 
   // json迭代器
   MemberIterator beginMember() {
-    assert(type_ == ValueType::TYPE_OBJECT);
-    return o_->data.begin();
+    assert(data_.type == ValueType::TYPE_OBJECT);
+    return data_.o->data.begin();
   }
   constMemberIterator cbeginMember() const {
-    assert(type_ == ValueType::TYPE_OBJECT);
-    return o_->data.cbegin();
+    assert(data_.type == ValueType::TYPE_OBJECT);
+    return data_.o->data.cbegin();
   }
   MemberIterator endMember() {
-    assert(type_ == ValueType::TYPE_OBJECT);
-    return o_->data.end();
+    assert(data_.type == ValueType::TYPE_OBJECT);
+    return data_.o->data.end();
   }
   constMemberIterator cendMember() const {
-    assert(type_ == ValueType::TYPE_OBJECT);
-    return o_->data.cend();
+    assert(data_.type == ValueType::TYPE_OBJECT);
+    return data_.o->data.cend();
   }
 
   constMemberIterator beginMember() const {
@@ -206,39 +257,78 @@ class Value {
   //对array添加
   template <typename T>
   Value &addValue(T &&value) {
-    assert(type_ == ValueType::TYPE_ARRAY);
-    a_->data.emplace_back(std::forward<T>(value));
-    return a_->data.back();
+    assert(data_.type == ValueType::TYPE_ARRAY);
+    data_.a->data.emplace_back(std::forward<T>(value));
+    return data_.a->data.back();
   }
 
   // 对array实现下标访问
   Value &operator[](size_t i) {
-    assert(type_ == ValueType::TYPE_ARRAY);
-    return a_->data[i];
+    assert(data_.type == ValueType::TYPE_ARRAY);
+    return data_.a->data[i];
   }
   const Value &operator[](size_t i) const {
-    assert(type_ == ValueType::TYPE_ARRAY);
-    return a_->data[i];
+    assert(data_.type == ValueType::TYPE_ARRAY);
+    return data_.a->data[i];
   }
 
-  //调用handler
+  //调用handler handler提供KeyDictionary时 key以KeyId事件发出
   template <typename Handler>
   inline bool writeTo(Handler &) const;
 
+ private:
+  // 构造一个不拥有内存的字符串 直接指向外部缓冲区 供原地解析使用
+  // 调用方需保证缓冲区比该Value及其所有拷贝活得久
+  static Value borrowString(std::string_view s) {
+    if (s.size() > std::numeric_limits<uint32_t>::max()) return Value(s);
+    Value value;
+    value.data_.type = ValueType::TYPE_STRING;
+    value.data_.kind = StringKind::VIEW;
+    value.data_.viewSize = static_cast<uint32_t>(s.size());
+    value.data_.view = s.data();
+    return value;
+  }
+
+  // 不减少引用计数直接置为null 节点随其内存池整块丢弃时使用
+  void abandon() { data_ = Layout(); }
+
+  // 以短字符串的布局写入 之后inline_为活动成员
+  void setInline(std::string_view s) {
+    inline_.type = ValueType::TYPE_STRING;
+    inline_.kind = StringKind::INLINE;
+    inline_.size = static_cast<uint8_t>(s.size());
+    std::copy(s.begin(), s.end(), inline_.chars);
+  }
+
+  // 按rhs的活动成员整体复制 不增加引用计数
+  void copyFrom(const Value &rhs) {
+    if (rhs.data_.type == ValueType::TYPE_STRING &&
+        rhs.data_.kind == StringKind::INLINE)
+      inline_ = rhs.inline_;
+    else
+      data_ = rhs.data_;
+  }
+
  private:
   // json string array object 类型的结构体模板
-  template <typename T,
-            typename = std::enable_if_t<std::is_same_v<T, std::vector<char>> ||
-                                        std::is_same_v<T, std::vector<Value>> ||
-                                        std::is_same_v<T, std::vector<Member>>>>
+  // data使用polymorphic_allocator 节点本身和data的内存来自同一个resource
+  template <typename T, typename = std::enable_if_t<
+                            std::is_same_v<T, std::pmr::vector<char>> ||
+                            std::is_same_v<T, std::pmr::vector<Value>> ||
+                            std::is_same_v<T, std::pmr::vector<Member>>>>
   struct AddRefCount {
     template <typename... Args>
     //可变参数模板 使用时不需要知名参数类型 编译器会自动推导
     // 1.利用右值 2.使用完美转发  ...用于展开参数包 将args依次发送到容器data
-    AddRefCount(Args &&... args)
-        : refCount(1), data(std::forward<Args>(args)...) {}
+    AddRefCount(std::pmr::memory_resource *resource, RefCountPolicy policy_,
+                Args &&... args)
+        : refCount(1),
+          policy(policy_),
+          data(std::forward<Args>(args)..., resource) {}
     ~AddRefCount() { assert(refCount == 0); }
 
+#if defined(GOA_JSON_REFCOUNT_ATOMIC) || defined(GOA_JSON_REFCOUNT_LOCAL)
+    // 编译时固定的方式 LOCAL时计数就是普通的int
     int incrAndGet() {
       assert(refCount > 0);
       return ++refCount;
@@ -247,34 +337,106 @@ class Value {
       assert(refCount > 0);
       return --refCount;
     }
+#else
+    // 两种方式共用同一种节点 计数须为原子类型
+    // LOCAL时拆成relaxed的load和store 编译为普通的加减 不产生lock前缀
+    int incrAndGet() {
+      assert(refCount > 0);
+      if (policy == RefCountPolicy::ATOMIC) return ++refCount;
+      int n = refCount.load(std::memory_order_relaxed) + 1;
+      refCount.store(n, std::memory_order_relaxed);
+      return n;
+    }
+    int decrAndGet() {
+      assert(refCount > 0);
+      if (policy == RefCountPolicy::ATOMIC) return --refCount;
+      int n = refCount.load(std::memory_order_relaxed) - 1;
+      refCount.store(n, std::memory_order_relaxed);
+      return n;
+    }
+#endif
 
+#if defined(GOA_JSON_REFCOUNT_LOCAL)
+    int refCount;
+#else
     //定义原子类型变量 支持 load store fetch_add fetch_sub 等操作
     std::atomic_int refCount;
+#endif
+    const RefCountPolicy policy;  // 占用refCount之后的空隙 不增加节点大小
     T data;
   };
 
   // using 定义类型别名 定义不同的AddRefCount结构体类型
   using StringWithRefCount =
-      AddRefCount<std::vector<char>>;  // json string类型 保存字符串
+      AddRefCount<std::pmr::vector<char>>;  // json string类型 保存字符串
   using ArrayWithRefCount =
-      AddRefCount<std::vector<Value>>;  // json array类型 保存json值
+      AddRefCount<std::pmr::vector<Value>>;  // json array类型 保存json值
   using ObjectWithRefCount =
-      AddRefCount<std::vector<Member>>;  // json object类型 保存键值对
+      AddRefCount<std::pmr::vector<Member>>;  // json object类型 保存键值对
+
+  template <typename Node, typename... Args>
+  static Node *newNode(std::pmr::memory_resource *resource,
+                       RefCountPolicy policy, Args &&... args) {
+    if (resource == nullptr) resource = std::pmr::new_delete_resource();
+    void *p = resource->allocate(sizeof(Node), alignof(Node));
+    return new (p) Node(resource, policy, std::forward<Args>(args)...);
+  }
 
-  ValueType type_;
+  // 节点记录在data的allocator中的resource上归还
+  template <typename Node>
+  static void deleteNode(Node *node) {
+    std::pmr::memory_resource *resource = node->data.get_allocator().resource();
+    node->~Node();
+    resource->deallocate(node, sizeof(Node), alignof(Node));
+  }
+
+  // string的存储方式
+  enum class StringKind : uint8_t {
+    OWNED,   // 引用计数的堆内存 data_.s
+    VIEW,    // 指向外部缓冲区 data_.view 长度data_.viewSize (原地解析)
+    INLINE,  // 存放在Value内 inline_.chars 长度inline_.size
+  };
+
+  // 短字符串以外的布局 type kind viewSize共用值之前的8字节 不增加Value的大小
+  struct Layout {
+    ValueType type;
+    StringKind kind;
+    uint32_t viewSize;
+
+    union {
+      bool b;
+      int32_t i32;
+      int64_t i64;
+      double d;
+      StringWithRefCount *s;  //结构体指针
+      ArrayWithRefCount *a;
+      ObjectWithRefCount *o;
+      const char *view;
+    };
+  };
 
+  // 短字符串的布局 内容占用type和kind之后的14字节 Value仍为16字节
+  struct InlineLayout {
+    ValueType type;
+    StringKind kind;
+    uint8_t size;
+    char chars[kInlineCapacity];
+  };
+
+  /*
+  两种布局的type和kind构成公共初始序列 无论哪个成员活动 都可以通过data_读取
+  其余成员只在由kind确认布局之后访问 拷贝和移动时整体复制活动的成员
+  初始为全零的data_ 即null
+  */
   union {
-    bool b_;
-    int32_t i32_;
-    int64_t i64_;
-    double d_;
-    StringWithRefCount *s_;  //结构体指针
-    ArrayWithRefCount *a_;
-    ObjectWithRefCount *o_;
+    Layout data_ = Layout();
+    InlineLayout inline_;
   };
 
 };  // end of class Value
 
+static_assert(std::is_standard_layout_v<Value>);
+
 // 这个结构体用于保存json object类型 保存键值对 其中键一般是string
 // 值可以是任意json类型 每个object视为一个成员
 struct Member {
@@ -289,8 +451,10 @@ struct Member {
 // definition of class Value's member functions
 
 // 构造函数
-inline Value::Value(ValueType type) : type_(type), s_(nullptr) {
-  switch (type_) {
+inline Value::Value(ValueType type, std::pmr::memory_resource *resource,
+                    RefCountPolicy policy) {
+  data_.type = type;
+  switch (type) {
     case ValueType::TYPE_NULL:
     case ValueType::TYPE_BOOL:
     case ValueType::TYPE_INT32:
@@ -298,13 +462,13 @@ inline Value::Value(ValueType type) : type_(type), s_(nullptr) {
     case ValueType::TYPE_DOUBLE:
       break;
     case ValueType::TYPE_STRING:
-      s_ = new StringWithRefCount();
-      break;  //此处开辟内存空间 利用AddRefCount模板
+      setInline(std::string_view());  // 空字符串 不必分配内存
+      break;
     case ValueType::TYPE_ARRAY:
-      a_ = new ArrayWithRefCount();
+      data_.a = newNode<ArrayWithRefCount>(resource, policy);
       break;
     case ValueType::TYPE_OBJECT:
-      o_ = new ObjectWithRefCount();
+      data_.o = newNode<ObjectWithRefCount>(resource, policy);
       break;
     default:
       assert(false && "bad type when Value construct");
@@ -312,8 +476,9 @@ inline Value::Value(ValueType type) : type_(type), s_(nullptr) {
 }
 
 // 这里浅拷贝  但使用引用计数 引用大于0原内存空间就不会被析构
-inline Value::Value(const Value &rhs) : type_(rhs.type_), s_(rhs.s_) {
-  switch (type_) {
+inline Value::Value(const Value &rhs) {
+  copyFrom(rhs);
+  switch (data_.type) {
     case ValueType::TYPE_NULL:
     case ValueType::TYPE_BOOL:
     case ValueType::TYPE_INT32:
@@ -321,22 +486,22 @@ inline Value::Value(const Value &rhs) : type_(rhs.type_), s_(rhs.s_) {
     case ValueType::TYPE_DOUBLE:
       break;
     case ValueType::TYPE_STRING:
-      s_->incrAndGet();
+      if (data_.kind == StringKind::OWNED) data_.s->incrAndGet();
       break;
     case ValueType::TYPE_ARRAY:
-      a_->incrAndGet();
+      data_.a->incrAndGet();
       break;
     case ValueType::TYPE_OBJECT:
-      o_->incrAndGet();
+      data_.o->incrAndGet();
       break;
     default:
       assert(false && "bad type when Value copy-construct");
   }
 }
 
-inline Value::Value(Value &&rhs) : type_(rhs.type_), s_(rhs.s_) {
-  rhs.type_ = ValueType::TYPE_NULL;
-  rhs.s_ = nullptr;  //原右值失效
+inline Value::Value(Value &&rhs) noexcept {
+  copyFrom(rhs);
+  rhs.data_ = Layout();  //原右值失效 置为null
 }
 
 // 类似拷贝构造
@@ -344,9 +509,8 @@ inline Value &Value::operator=(const Value &rhs) {
   if (this == &rhs) return *this;  // copy itself
 
   this->~Value();
-  type_ = rhs.type_;
-  s_ = rhs.s_;
-  switch (type_) {
+  copyFrom(rhs);
+  switch (data_.type) {
     case ValueType::TYPE_NULL:
     case ValueType::TYPE_BOOL:
     case ValueType::TYPE_INT32:
@@ -354,13 +518,13 @@ inline Value &Value::operator=(const Value &rhs) {
     case ValueType::TYPE_DOUBLE:
       break;
     case ValueType::TYPE_STRING:
-      s_->incrAndGet();
+      if (data_.kind == StringKind::OWNED) data_.s->incrAndGet();
       break;
     case ValueType::TYPE_ARRAY:
-      a_->incrAndGet();
+      data_.a->incrAndGet();
       break;
     case ValueType::TYPE_OBJECT:
-      o_->incrAndGet();
+      data_.o->incrAndGet();
       break;
     default:
       assert(false && "bad type when Value copy");
@@ -369,21 +533,19 @@ inline Value &Value::operator=(const Value &rhs) {
 }
 
 // 移动赋值
-inline Value &Value::operator=(Value &&rhs) {
+inline Value &Value::operator=(Value &&rhs) noexcept {
   if (this == &rhs) return *this;
 
   this->~Value();
-  type_ = rhs.type_;
-  s_ = rhs.s_;
-  rhs.type_ = ValueType::TYPE_NULL;
-  rhs.s_ = nullptr;  //原右值失效
+  copyFrom(rhs);
+  rhs.data_ = Layout();  //原右值失效 置为null
   return *this;
 }
 
 // 析构函数
 // 对于非基础数据类型 需判断引用计数是否为0 若为0 则释放内存空间
 inline Value::~Value() {
-  switch (type_) {
+  switch (data_.type) {
     case ValueType::TYPE_NULL:
     case ValueType::TYPE_BOOL:
     case ValueType::TYPE_INT32:
@@ -391,13 +553,14 @@ inline Value::~Value() {
     case ValueType::TYPE_DOUBLE:
       break;
     case ValueType::TYPE_STRING:
-      if (s_->decrAndGet() == 0) delete s_;
+      if (data_.kind == StringKind::OWNED && data_.s->decrAndGet() == 0)
+        deleteNode(data_.s);
       break;
     case ValueType::TYPE_ARRAY:
-      if (a_->decrAndGet() == 0) delete a_;
+      if (data_.a->decrAndGet() == 0) deleteNode(data_.a);
       break;
     case ValueType::TYPE_OBJECT:
-      if (o_->decrAndGet() == 0) delete o_;
+      if (data_.o->decrAndGet() == 0) deleteNode(data_.o);
       break;
     default:
       assert(false && "bad type when Value deconstruct");
@@ -406,20 +569,20 @@ inline Value::~Value() {
 
 //此处是数据的数量 而不是内存大小
 inline size_t Value::getSize() const {
-  if (type_ == ValueType::TYPE_ARRAY)
-    return a_->data.size();
-  else if (type_ == ValueType::TYPE_OBJECT)
-    return o_->data.size();
+  if (data_.type == ValueType::TYPE_ARRAY)
+    return data_.a->data.size();
+  else if (data_.type == ValueType::TYPE_OBJECT)
+    return data_.o->data.size();
   //对于非array 非object 数量为1
   return 1;
 }
 
 // 对object类型 用key访问
 inline Value &Value::operator[](const std::string_view &key) {
-  assert(type_ == ValueType::TYPE_OBJECT);
+  assert(data_.type == ValueType::TYPE_OBJECT);
 
   auto iter = findMember(key);
-  if (iter != o_->data.end()) return iter->value;
+  if (iter != data_.o->data.end()) return iter->value;
 
   assert(false);
   static Value fake(ValueType::TYPE_NULL);
@@ -431,8 +594,9 @@ inline Value &Value::operator[](const std::string_view &key) const {
 }
 
 inline Value::MemberIterator Value::findMember(const std::string_view &key) {
-  assert(type_ == ValueType::TYPE_OBJECT);
-  return std::find_if(o_->data.begin(), o_->data.end(), [key](const Member &m) {
+  assert(data_.type == ValueType::TYPE_OBJECT);
+  auto &members = data_.o->data;
+  return std::find_if(members.begin(), members.end(), [key](const Member &m) {
     return m.key.getStringView() == key;
   });
 }
@@ -443,13 +607,13 @@ inline Value::constMemberIterator Value::findMember(
 }
 
 inline Value &Value::addMember(Value &&k, Value &&v) {
-  assert(type_ == ValueType::TYPE_OBJECT);
-  assert(k.type_ == ValueType::TYPE_STRING);
+  assert(data_.type == ValueType::TYPE_OBJECT);
+  assert(k.data_.type == ValueType::TYPE_STRING);
   assert(findMember(k.getStringView()) == endMember());
-  o_->data.emplace_back(
+  data_.o->data.emplace_back(
       std::move(k),
       std::move(v));  // std::move 对象转换为右值引用 然后调用移动构造或赋值函数
-  return o_->data.back().value;
+  return data_.o->data.back().value;
 }
 
 #define CALL(expr)             \
@@ -462,21 +626,21 @@ inline Value &Value::addMember(Value &&k, Value &&v) {
 */
 template <typename Handler>
 inline bool Value::writeTo(Handler &handler) const {
-  switch (type_) {
+  switch (data_.type) {
     case ValueType::TYPE_NULL:
       CALL(handler.Null());  //类型检查
       break;
     case ValueType::TYPE_BOOL:
-      CALL(handler.Bool(b_));
+      CALL(handler.Bool(data_.b));
       break;
     case ValueType::TYPE_INT32:
-      CALL(handler.Int32(i32_));
+      CALL(handler.Int32(data_.i32));
       break;
     case ValueType::TYPE_INT64:
-      CALL(handler.Int64(i64_));
+      CALL(handler.Int64(data_.i64));
       break;
     case ValueType::TYPE_DOUBLE:
-      CALL(handler.Double(d_));
+      CALL(handler.Double(data_.d));
       break;
     case ValueType::TYPE_STRING:
       CALL(handler.String(getStringView()));
@@ -489,7 +653,7 @@ inline bool Value::writeTo(Handler &handler) const {
     case ValueType::TYPE_OBJECT:
       CALL(handler.StartObject());
       for (auto &member : getObject()) {
-        handler.Key(member.key.getStringView());
+        CALL(emitKey(handler, member.key.getStringView()));  //与Reader相同
         CALL(member.value.writeTo(handler));
       }
       CALL(handler.EndObject());
@@ -4,6 +4,7 @@
 #include <cmath>
 #include <cstring>
 
+#include "SimdKernels.hpp"
 #include "Value.hpp"
 
 namespace goa {
@@ -190,43 +191,17 @@ class Writer : noncopyable {
   bool String(std::string_view s) {
     prefix(ValueType::TYPE_STRING);
     os_.put('"');
-    for (auto c : s) {
-      auto u = static_cast<unsigned char>(c);
-      switch (u) {
-        // 转义字符特殊处理
-        // json字符串中要保留转移符
-        case '\"':
-          os_.put("\\\"");
-          break;
-        case '\\':
-          os_.put("\\\\");
-          break;
-        case '\b':
-          os_.put("\\b");
-          break;
-        case '\f':
-          os_.put("\\f");
-          break;
-        case '\n':
-          os_.put("\\n");
-          break;
-        case '\r':
-          os_.put("\\r");
-          break;
-        case '\t':
-          os_.put("\\t");
-          break;
-        default:
-          if (u < 0x20) {
-            char buf[7];
-            snprintf(buf, 7, "\\u%04X", u);
-            os_.put(buf);
-          } else
-            os_.put(c);
-          break;
-      }
+    // 用SIMD内核找到下一个需要转义的字符 其间的普通字符整段输出
+    auto scanString = simd::kernels().scanString;
+    const char *p = s.data(), *end = s.data() + s.size();
+    while (p < end) {
+      const char *special = scanString(p, end);
+      if (special != p)
+        os_.put(std::string_view(p, static_cast<size_t>(special - p)));
+      if (special == end) break;
+      putEscaped(*special);
+      p = special + 1;
     }
-
     os_.put('"');
     return true;
   }
@@ -271,6 +246,42 @@ class Writer : noncopyable {
   }
 
  private:
+  void putEscaped(char c) {
+    auto u = static_cast<unsigned char>(c);
+    switch (u) {
+      // 转义字符特殊处理
+      // json字符串中要保留转移符
+      case '\"':
+        os_.put("\\\"");
+        break;
+      case '\\':
+        os_.put("\\\\");
+        break;
+      case '\b':
+        os_.put("\\b");
+        break;
+      case '\f':
+        os_.put("\\f");
+        break;
+      case '\n':
+        os_.put("\\n");
+        break;
+      case '\r':
+        os_.put("\\r");
+        break;
+      case '\t':
+        os_.put("\\t");
+        break;
+      default: {
+        assert(u < 0x20);
+        char buf[7];
+        snprintf(buf, 7, "\\u%04X", u);
+        os_.put(buf);
+        break;
+      }
+    }
+  }
+
   struct Level {
     explicit Level(bool inArray_) : inArray(inArray_), valueCount(0) {}
 
@@ -0,0 +1,236 @@
+#include <gtest/gtest.h>
+
+#include <Document.hpp>
+#include <StringWriteStream.hpp>
+#include <Writer.hpp>
+#include <memory_resource>
+#include <string>
+
+using namespace goa::json;
+
+inline std::string writeString(const Value &value) {
+  StringWriteStream os;
+  Writer writer(os);
+  value.writeTo(writer);
+  return os.getString();
+}
+
+inline bool pointsInto(std::string_view s, const char *begin, size_t len) {
+  return s.data() >= begin && s.data() + s.size() <= begin + len;
+}
+
+TEST(json_document, insitu) {
+  std::string json =
+      "{\"plain\":\"abc\",\"escaped\\n\":\"a\\\"b\\u00e9\\ud83d\\ude00\","
+      "\"a\":[\"x\",1,null]}";
+  std::string buffer = json;
+
+  Document doc;
+  ASSERT_EQ(doc.parseInsitu(buffer.data(), buffer.size()),
+            ParseError::PARSE_OK);
+  // key和string都直接指向缓冲区
+  EXPECT_TRUE(pointsInto(doc["plain"].getStringView(), buffer.data(),
+                         buffer.size()));
+  auto escaped = doc["escaped\n"].getStringView();
+  EXPECT_TRUE(pointsInto(escaped, buffer.data(), buffer.size()));
+  EXPECT_EQ(escaped, "a\"b\xC3\xA9\xF0\x9F\x98\x80");
+  EXPECT_EQ(doc["a"][0].getStringView(), "x");
+
+  Document expect;
+  ASSERT_EQ(expect.parse(json), ParseError::PARSE_OK);
+  EXPECT_EQ(writeString(doc), writeString(expect));
+
+  // 拷贝出的Value仍然指向缓冲区
+  Value copy = doc["plain"];
+  EXPECT_EQ(copy.getStringView().data(), doc["plain"].getStringView().data());
+}
+
+TEST(json_document, insitu_owned) {
+  Document doc;
+  ASSERT_EQ(doc.parseInsitu(std::string("[\"a\\tb\",\"c\"]")),
+            ParseError::PARSE_OK);
+  EXPECT_EQ(doc[0].getStringView(), "a\tb");
+  EXPECT_EQ(doc[1].getStringView(), "c");
+  EXPECT_EQ(writeString(doc), "[\"a\\tb\",\"c\"]");
+}
+
+TEST(json_document, insitu_error) {
+  std::string buffer = "{\"a\":\"b\\x\"}";
+  Document doc;
+  EXPECT_EQ(doc.parseInsitu(buffer.data(), buffer.size()),
+            ParseError::PARSE_BAD_STRING_ESCAPE);
+
+  // 原地解析同样接受解析选项
+  Document loose, strict;
+  EXPECT_EQ(loose.parseInsitu(std::string("[NaN, 1i64]")),
+            ParseError::PARSE_OK);
+  EXPECT_EQ(strict.parseInsitu<kParseStrictFlags>(std::string("[NaN]")),
+            ParseError::PARSE_BAD_VALUE);
+  std::string bad = "[\"\xc3\"]";
+  EXPECT_EQ(strict.parseInsitu<kParseValidateUtf8Flag>(bad.data(), bad.size()),
+            ParseError::PARSE_BAD_UTF8);
+}
+
+TEST(json_document, string_pool) {
+  std::string json =
+      "[{\"sellerNickname\":\"CAN_CHANGE_SKU\",\"id\":\"1\"},"
+      "{\"sellerNickname\":\"CAN_CHANGE_SKU\",\"id\":\"2\"},"
+      "{\"sellerNickname\":\"a very long value that is not interned\","
+      "\"id\":\"sellerNickname\"}]";
+  StringPool pool(32);
+  Document doc;
+  ASSERT_EQ(doc.parse(json, pool), ParseError::PARSE_OK);
+
+  // 相同的key和值共享同一份数据
+  auto key = [&](size_t i, size_t j) {
+    return doc[i].getObject()[j].key.getStringView();
+  };
+  EXPECT_EQ(key(0, 0).data(), key(1, 0).data());
+  EXPECT_EQ(key(0, 0).data(), key(2, 0).data());
+  EXPECT_EQ(doc[0]["sellerNickname"].getStringView().data(),
+            doc[1]["sellerNickname"].getStringView().data());
+  EXPECT_EQ(doc[2]["id"].getStringView().data(), key(0, 0).data());
+  // 短字符串存放在各自的Value内
+  EXPECT_NE(key(0, 1).data(), key(1, 1).data());
+  // 后两次的key 第二个CAN_CHANGE_SKU 以及作为值的"sellerNickname"
+  EXPECT_EQ(pool.getHits(), 4u);
+  EXPECT_EQ(pool.getSize(), 2u);
+
+  Document expect;
+  ASSERT_EQ(expect.parse(json), ParseError::PARSE_OK);
+  EXPECT_EQ(writeString(doc), writeString(expect));
+
+  // 池可供其他Document继续使用 清空后已解析的文档不受影响
+  Document other;
+  ASSERT_EQ(other.parse("{\"status\":\"CAN_CHANGE_SKU\"}", pool),
+            ParseError::PARSE_OK);
+  EXPECT_EQ(other["status"].getStringView().data(),
+            doc[0]["sellerNickname"].getStringView().data());
+  pool.clear();
+  doc[0]["sellerNickname"].setString("changed");
+  EXPECT_EQ(doc[1]["sellerNickname"].getStringView(), "CAN_CHANGE_SKU");
+  EXPECT_EQ(other["status"].getStringView(), "CAN_CHANGE_SKU");
+}
+
+// 统计经过的分配和释放次数
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  size_t allocated = 0, deallocated = 0;
+
+ private:
+  void *do_allocate(size_t bytes, size_t alignment) override {
+    allocated++;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+    deallocated++;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+};
+
+TEST(json_document, arena) {
+  std::string json =
+      "{\"items\":[{\"title\":\"a title longer than inline\",\"id\":1},"
+      "{\"tags\":[\"x\",\"another long string value\"]}],\"empty\":{}}";
+  Document expect;
+  ASSERT_EQ(expect.parse(json), ParseError::PARSE_OK);
+
+  // 所有节点及数组和对象的增长都从调用方的resource分配
+  CountingResource counting;
+  {
+    Document doc(&counting);
+    ASSERT_EQ(doc.parse(json), ParseError::PARSE_OK);
+    EXPECT_EQ(writeString(doc), writeString(expect));
+    EXPECT_GT(counting.allocated, 10u);
+  }
+  EXPECT_EQ(counting.allocated, counting.deallocated);
+
+  // 请求级别的内存池可在文档释放后重复使用
+  std::pmr::monotonic_buffer_resource pool(&counting);
+  for (int i = 0; i < 3; i++) {
+    {
+      Document doc(&pool);
+      ASSERT_EQ(doc.parse(json), ParseError::PARSE_OK);
+      EXPECT_EQ(writeString(doc), writeString(expect));
+    }
+    pool.release();
+  }
+
+  // Document自己持有的内存池 插入的值也从池中分配 拷贝共享同一个池
+  Document copy;
+  {
+    Document doc = Document::withArena(256);
+    ASSERT_EQ(doc.parse(json), ParseError::PARSE_OK);
+    auto *arena = doc.getMemoryResource();
+    doc["items"][1]["tags"].addValue(Value("a string from the arena", arena));
+    doc["empty"].addMember("k", Value(ValueType::TYPE_ARRAY, arena));
+    copy = doc;
+  }
+  EXPECT_EQ(copy["items"][0]["title"].getStringView(),
+            "a title longer than inline");
+  EXPECT_EQ(copy["items"][1]["tags"][2].getStringView(),
+            "a string from the arena");
+
+  // 字符串池按Document的方式分配 池须先于持有内存池的Document销毁
+  CountingResource strings;
+  {
+    Document doc(&strings, RefCountPolicy::LOCAL);
+    StringPool strPool(64, &strings, RefCountPolicy::LOCAL);
+    ASSERT_EQ(doc.parse(json, strPool), ParseError::PARSE_OK);
+    EXPECT_EQ(writeString(doc), writeString(expect));
+    EXPECT_GT(strPool.getSize(), 0u);
+  }
+  EXPECT_GT(strings.allocated, 0u);
+  EXPECT_EQ(strings.allocated, strings.deallocated);
+  Document pooled = Document::withArena(256);
+  {
+    StringPool strPool(64, pooled.getMemoryResource());
+    ASSERT_EQ(pooled.parse(json, strPool), ParseError::PARSE_OK);
+  }
+  EXPECT_EQ(writeString(pooled), writeString(expect));
+}
+
+// 解析在长key之后失败 未挂到树上的key同样要在内存池之前释放
+TEST(json_document, arena_error) {
+  Document doc = Document::withArena(256);
+  EXPECT_EQ(doc.parse("{\"a_rather_long_key_name\": "),
+            ParseError::PARSE_EXPECT_VALUE);
+  Document nested = Document::withArena(256);
+  EXPECT_EQ(nested.parse("[{\"a_rather_long_key_name\": [1, }]"),
+            ParseError::PARSE_BAD_VALUE);
+}
+
+// 单线程的引用计数 拷贝和修改的语义不变
+TEST(json_document, local_refcount) {
+  std::string json =
+      "{\"items\":[{\"title\":\"a title longer than inline\",\"id\":1}],"
+      "\"tags\":[\"x\",\"another long string value\"]}";
+  Document expect;
+  ASSERT_EQ(expect.parse(json), ParseError::PARSE_OK);
+
+  Document doc(RefCountPolicy::LOCAL);
+  ASSERT_EQ(doc.parse(json), ParseError::PARSE_OK);
+  EXPECT_EQ(writeString(doc), writeString(expect));
+
+  Value items = doc["items"];
+  Value title = items[0]["title"];
+  {
+    Document copy = doc;
+    copy.setNull();
+  }
+  doc["items"][0]["title"].setString("changed");
+  EXPECT_EQ(title.getStringView(), "a title longer than inline");
+  EXPECT_EQ(items[0]["title"].getStringView(), "changed");
+
+  Document arena = Document::withArena(1024, RefCountPolicy::LOCAL);
+  ASSERT_EQ(arena.parse(json), ParseError::PARSE_OK);
+  EXPECT_EQ(writeString(arena), writeString(expect));
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1,8 +1,11 @@
 #include <gtest/gtest.h>
 
+#include <AsyncFileReadStream.hpp>
 #include <Document.hpp>
+#include <MmapReadStream.hpp>
 #include <StringWriteStream.hpp>
 #include <Writer.hpp>
+#include <cmath>
 #include <iostream>
 
 using namespace goa::json;
@@ -17,7 +20,7 @@ inline void TEST_FILEREAD(const std::string &json) {
   EXPECT_EQ(json, os.getStringView());
 }
 
-std::string jsonDir("../../bench/taobao/cart.json");
+std::string jsonDir(GOA_JSON_DATA_DIR "/cart.json");
 
 TEST(FileRelative, read) {
   FILE *input = fopen(jsonDir.c_str(), "r");
@@ -52,6 +55,197 @@ TEST(FileRelative, read_parse_write) {
   EXPECT_TRUE(b);
 }
 
+static std::string writeDocument(const Document &doc) {
+  StringWriteStream os;
+  Writer writer(os);
+  doc.writeTo(writer);
+  return std::string(os.getStringView());
+}
+
+static FILE *openString(const std::string &json) {
+  FILE *input = tmpfile();
+  fwrite(json.data(), 1, json.size(), input);
+  rewind(input);
+  return input;
+}
+
+// 缓冲区远小于文件时 结果与一次读入整个文件相同
+TEST(FileRelative, buffered_parse) {
+  FILE *input = fopen(jsonDir.c_str(), "r");
+  if (input == nullptr) exit(1);
+  FileReadStream whole(input);
+  Document expect;
+  ASSERT_EQ(expect.parseStream(whole), ParseError::PARSE_OK);
+
+  for (size_t bufferSize : {1, 2, 3, 7, 64, 4096}) {
+    rewind(input);
+    BufferedFileReadStream is(input, bufferSize);
+    Document doc;
+    ASSERT_EQ(doc.parseStream(is), ParseError::PARSE_OK);
+    EXPECT_EQ(writeDocument(doc), writeDocument(expect));
+  }
+  fclose(input);
+}
+
+// 数字和空白跨越缓冲区边界
+TEST(FileRelative, buffered_boundary) {
+  std::string json =
+      "[0, -12345678901234567, 3.14159265358979323846, 1e-300, "
+      "-0.000123456789E+12, 9223372036854775807, 2147483647,\n\n"
+      "                                   \"abc\\n\\u00e9\", true]";
+  Document expect;
+  ASSERT_EQ(expect.parse(json), ParseError::PARSE_OK);
+  for (size_t bufferSize = 1; bufferSize <= 40; bufferSize++) {
+    FILE *input = openString(json);
+    BufferedFileReadStream is(input, bufferSize);
+    Document doc;
+    ASSERT_EQ(doc.parseStream(is), ParseError::PARSE_OK);
+    fclose(input);
+    EXPECT_EQ(writeDocument(doc), writeDocument(expect)) << bufferSize;
+  }
+}
+
+// 多字节字符被缓冲区截断时 校验UTF-8不应误报
+TEST(FileRelative, buffered_utf8) {
+  constexpr unsigned kFlags = kParseDefaultFlags | kParseValidateUtf8Flag;
+  std::string json =
+      "[\"\xe8\x9b\xa4\xf0\x9f\x98\x80"
+      "a\xc3\xa9\\n\xe4\xb8\xad\"]";
+  Document expect;
+  ASSERT_EQ(expect.parse(json), ParseError::PARSE_OK);
+  for (size_t bufferSize = 1; bufferSize <= 20; bufferSize++) {
+    FILE *input = openString(json);
+    BufferedFileReadStream is(input, bufferSize);
+    Document doc;
+    ASSERT_EQ(doc.parseStream<kFlags>(is), ParseError::PARSE_OK) << bufferSize;
+    fclose(input);
+    EXPECT_EQ(writeDocument(doc), writeDocument(expect)) << bufferSize;
+
+    input = openString("[\"\xe8\x9b\xa4\xe8\x9b\"]");
+    BufferedFileReadStream bad(input, bufferSize);
+    Document badDoc;
+    EXPECT_EQ(badDoc.parseStream<kFlags>(bad), ParseError::PARSE_BAD_UTF8);
+    fclose(input);
+  }
+}
+
+// 预读的流与BufferedFileReadStream结果相同
+TEST(FileRelative, async_parse) {
+  FILE *input = fopen(jsonDir.c_str(), "r");
+  if (input == nullptr) exit(1);
+  FileReadStream whole(input);
+  Document expect;
+  ASSERT_EQ(expect.parseStream(whole), ParseError::PARSE_OK);
+
+  for (size_t bufferSize : {1, 7, 4096, 1 << 18}) {
+    rewind(input);
+    AsyncFileReadStream is(input, bufferSize);
+    Document doc;
+    ASSERT_EQ(doc.parseStream(is), ParseError::PARSE_OK);
+    EXPECT_EQ(writeDocument(doc), writeDocument(expect));
+  }
+  fclose(input);
+
+  std::string json = "[3.14159265358979323846, -0.000123456789E+12, 1]";
+  for (size_t bufferSize = 1; bufferSize <= 20; bufferSize++) {
+    input = openString(json);
+    AsyncFileReadStream is(input, bufferSize);
+    Document doc;
+    ASSERT_EQ(doc.parseStream(is), ParseError::PARSE_OK);
+    EXPECT_EQ(doc[0].getDouble(), 3.14159265358979323846);
+    EXPECT_EQ(doc[1].getDouble(), -0.000123456789E+12);
+    fclose(input);
+  }
+}
+
+// 未读完就析构时后台线程能够退出
+TEST(FileRelative, async_early_exit) {
+  FILE *input = openString("[1, 2] [3]");
+  {
+    AsyncFileReadStream is(input, 2);
+    Document doc;
+    EXPECT_EQ(doc.parseStream(is), ParseError::PARSE_ROOT_NOT_SINGULAR);
+  }
+  {
+    AsyncFileReadStream unused(input);
+  }
+  fclose(input);
+}
+
+TEST(FileRelative, buffered_error) {
+  for (std::string json : {"[1, 2, tru]", "{\"a\": 1.}", "[1] 2", "  ",
+                           "[\"abc\x01\"]", "[1, 2"}) {
+    Document expect;
+    ParseResult result = expect.parse(json);
+    ASSERT_NE(result, ParseError::PARSE_OK);
+    for (size_t bufferSize : {1, 3, 64}) {
+      FILE *input = openString(json);
+      BufferedFileReadStream is(input, bufferSize);
+      Document doc;
+      ParseResult buffered = doc.parseStream(is);
+      fclose(input);
+      EXPECT_EQ(buffered.err(), result.err()) << json;
+      EXPECT_EQ(buffered.getOffset(), result.getOffset()) << json;
+
+      input = openString(json);
+      ParseResult async;
+      {
+        AsyncFileReadStream asyncStream(input, bufferSize);
+        Document asyncDoc;
+        async = asyncDoc.parseStream(asyncStream);
+      }
+      fclose(input);
+      EXPECT_EQ(async.err(), result.err()) << json;
+      EXPECT_EQ(async.getOffset(), result.getOffset()) << json;
+    }
+  }
+}
+
+TEST(FileRelative, mmap_parse) {
+  FILE *input = fopen(jsonDir.c_str(), "r");
+  if (input == nullptr) exit(1);
+  FileReadStream whole(input);
+  rewind(input);
+  MmapReadStream is(input);
+  fclose(input);
+  EXPECT_TRUE(is.isMapped());
+  EXPECT_EQ(is.getRemaining().size(), whole.getRemaining().size());
+
+  Document expect, doc;
+  ASSERT_EQ(expect.parseStream(whole), ParseError::PARSE_OK);
+  ASSERT_EQ(doc.parseStream(is), ParseError::PARSE_OK);
+  EXPECT_EQ(writeDocument(doc), writeDocument(expect));
+}
+
+// 从文件的当前位置开始读取
+TEST(FileRelative, mmap_offset) {
+  FILE *input = openString("garbage [1, 2]");
+  fseek(input, 8, SEEK_SET);
+  MmapReadStream is(input);
+  fclose(input);
+  EXPECT_TRUE(is.isMapped());
+  Document doc;
+  ASSERT_EQ(doc.parseStream(is), ParseError::PARSE_OK);
+  EXPECT_EQ(doc[1].getInt32(), 2);
+}
+
+// 管道无法映射 退回到读入缓冲区
+TEST(FileRelative, mmap_pipe) {
+  FILE *input = popen(("cat " + jsonDir).c_str(), "r");
+  if (input == nullptr) exit(1);
+  MmapReadStream is(input);
+  pclose(input);
+  EXPECT_FALSE(is.isMapped());
+  Document doc;
+  EXPECT_EQ(doc.parseStream(is), ParseError::PARSE_OK);
+
+  FILE *empty = openString("");
+  MmapReadStream none(empty);
+  fclose(empty);
+  EXPECT_FALSE(none.hasNext());
+  EXPECT_EQ(doc.parseStream(none), ParseError::PARSE_EXPECT_VALUE);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <Document.hpp>
+#include <PathFilter.hpp>
+#include <StringWriteStream.hpp>
+#include <Writer.hpp>
+#include <fstream>
+#include <sstream>
+
+using namespace goa::json;
+
+// 按filter解析后写回json 用于比较保留下来的部分
+inline std::string project(const std::string &json, const PathFilter &filter) {
+  Document doc;
+  EXPECT_EQ(doc.parse(json, filter), ParseError::PARSE_OK) << json;
+  StringWriteStream os;
+  Writer writer(os);
+  doc.writeTo(writer);
+  return std::string(os.getStringView());
+}
+
+TEST(json_filter, object) {
+  std::string json =
+      "{\"a\": 1, \"b\": {\"c\": \"x\", \"d\": [1, 2]}, \"e\": null}";
+  EXPECT_EQ(project(json, {"/a"}), "{\"a\":1}");
+  EXPECT_EQ(project(json, {"/b/d"}), "{\"b\":{\"d\":[1,2]}}");
+  EXPECT_EQ(project(json, {"/b/c", "/e"}), "{\"b\":{\"c\":\"x\"},\"e\":null}");
+  EXPECT_EQ(project(json, {"/none"}), "{}");
+  // 路径中间的值不是对象 不保留
+  EXPECT_EQ(project(json, {"/a/x"}), "{}");
+  // 空路径表示整个文档
+  EXPECT_EQ(project(json, {""}),
+            "{\"a\":1,\"b\":{\"c\":\"x\",\"d\":[1,2]},\"e\":null}");
+}
+
+TEST(json_filter, wildcard) {
+  std::string json =
+      "{\"items\": {\"x\": {\"price\": 1, \"name\": \"a\"},"
+      " \"y\": {\"price\": 2.5, \"name\": \"b\"}, \"z\": 3},"
+      " \"list\": [{\"id\": 1, \"v\": true}, {\"id\": 2}, 5]}";
+  EXPECT_EQ(project(json, {"/items/*/price"}),
+            "{\"items\":{\"x\":{\"price\":1},\"y\":{\"price\":2.5}}}");
+  EXPECT_EQ(project(json, {"/list/*/id"}),
+            "{\"list\":[{\"id\":1},{\"id\":2}]}");
+  EXPECT_EQ(project(json, {"/list/1"}), "{\"list\":[{\"id\":2}]}");
+  EXPECT_EQ(project(json, {"/list/*/id", "/list/0/v"}),
+            "{\"list\":[{\"id\":1,\"v\":true},{\"id\":2}]}");
+  // 通配和具体key同时匹配时 两条路径都生效
+  EXPECT_EQ(project(json, {"/items/*/price", "/items/y/name"}),
+            "{\"items\":{\"x\":{\"price\":1},"
+            "\"y\":{\"price\":2.5,\"name\":\"b\"}}}");
+  EXPECT_EQ(project(json, {"/items/y/name", "/items/*/price"}),
+            "{\"items\":{\"x\":{\"price\":1},"
+            "\"y\":{\"price\":2.5,\"name\":\"b\"}}}");
+}
+
+TEST(json_filter, escape) {
+  std::string json = "{\"a/b\": 1, \"m~n\": 2, \"q\\\"\": {\"k\": 3}}";
+  EXPECT_EQ(project(json, {"/a~1b"}), "{\"a/b\":1}");
+  EXPECT_EQ(project(json, {"/m~0n"}), "{\"m~n\":2}");
+  Document doc;
+  ASSERT_EQ(doc.parse(json, {"/q\"/k"}), ParseError::PARSE_OK);
+  EXPECT_EQ(doc.getSize(), 1u);
+  EXPECT_EQ(doc["q\""]["k"].getInt32(), 3);
+
+  PathFilter filter;
+  EXPECT_FALSE(filter.add("a"));
+  EXPECT_FALSE(filter.add("/a~2"));
+  EXPECT_TRUE(filter.add("/a~1b"));
+}
+
+// 跳过的部分与完整解析的错误码相同
+TEST(json_filter, error) {
+  PathFilter filter{"/keep"};
+  for (std::string json :
+       {"{\"skip\": [1, 2}", "{\"skip\": \"\\x\"}", "{\"skip\": 01}",
+        "{\"skip\": \"\\ud800\"}", "{\"skip\": 1e400}", "{\"skip\": tru}",
+        "{\"skip\": {\"a\" 1}}", "{\"skip\": \"\x01\"}", "{\"skip\": 1",
+        "{\"skip\": 99999999999999999999}", "{\"skip\": 1} x",
+        "{\"skip\": 1e-400}", "{\"skip\": 1.5e300, \"keep\": [1,]}"}) {
+    Document expect, actual;
+    ParseError err1 = expect.parse(json);
+    ParseError err2 = actual.parse(json, filter);
+    EXPECT_NE(err1, ParseError::PARSE_OK) << json;
+    EXPECT_EQ(err1, err2) << json;
+  }
+}
+
+// 解析选项同样作用于保留和跳过的部分
+TEST(json_filter, flags) {
+  PathFilter filter{"/keep"};
+  constexpr unsigned kFlags = kParseStrictFlags | kParseValidateUtf8Flag;
+  for (std::string json : {"{\"keep\": NaN}", "{\"skip\": [Infinity]}",
+                           "{\"keep\": 1i32}", "{\"skip\": \"\xff\"}"}) {
+    Document loose, strict;
+    EXPECT_EQ(loose.parse(json, filter), ParseError::PARSE_OK) << json;
+    EXPECT_NE(strict.parse<kFlags>(json, filter), ParseError::PARSE_OK)
+        << json;
+  }
+}
+
+// 跳过的值不产生任何事件
+TEST(json_filter, events) {
+  struct Counter : noncopyable {
+    bool Null() { return count(); }
+    bool Bool(bool) { return count(); }
+    bool Int32(int32_t) { return count(); }
+    bool Int64(int64_t) { return count(); }
+    bool Double(double) { return count(); }
+    bool String(std::string_view) { return count(); }
+    bool StartObject() { return count(); }
+    bool Key(std::string_view) { return count(); }
+    bool EndObject() { return count(); }
+    bool StartArray() { return count(); }
+    bool EndArray() { return count(); }
+    bool count() {
+      events++;
+      return true;
+    }
+    int events = 0;
+  } counter;
+  std::string json =
+      "{\"skip\": [1, \"a\\n\", {\"b\": null}], \"keep\": 1, \"x\": 2}";
+  StringReadStream is(json);
+  EXPECT_EQ(Reader::parse(is, counter, PathFilter{"/keep"}),
+            ParseError::PARSE_OK);
+  EXPECT_EQ(counter.events, 4);  // { keep 1 }
+}
+
+TEST(json_filter, taobao) {
+  std::ifstream in(GOA_JSON_DATA_DIR "/cart.json");
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  std::string json = buffer.str();
+  ASSERT_FALSE(json.empty());
+
+  Document full;
+  ASSERT_EQ(full.parse(json), ParseError::PARSE_OK);
+  Document doc;
+  ASSERT_EQ(doc.parse(json, {"/data/pageMeta", "/data/data/*/tag", "/api"}),
+            ParseError::PARSE_OK);
+  EXPECT_EQ(doc.getSize(), 2u);
+  EXPECT_EQ(doc["api"].getStringView(), full["api"].getStringView());
+  EXPECT_EQ(doc["data"]["pageMeta"]["totalCount"].getInt64(),
+            full["data"]["pageMeta"]["totalCount"].getInt64());
+  auto &data = doc["data"]["data"];
+  EXPECT_EQ(data.getSize(), full["data"]["data"].getSize());
+  for (auto &member : data.getObject()) {
+    auto &expect = full["data"]["data"][member.key.getStringView()];
+    EXPECT_EQ(member.value["tag"].getStringView(),
+              expect["tag"].getStringView());
+  }
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
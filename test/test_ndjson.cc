@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <NdjsonParser.hpp>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+
+using namespace goa::json;
+
+TEST(json_ndjson, thread_pool) {
+  ThreadPool pool(4);
+  EXPECT_EQ(pool.getThreads(), 4u);
+  for (size_t n : {0, 1, 3, 1000}) {
+    std::vector<std::atomic<int>> counts(n);
+    pool.parallelFor(n, [&](size_t i) { counts[i]++; });
+    for (auto &count : counts) EXPECT_EQ(count, 1);
+  }
+}
+
+TEST(json_ndjson, lines) {
+  std::string input =
+      "{\"a\": 1}\n"
+      "\n"
+      "[1, \"x\\ny\"]\r\n"
+      "   \t\n"
+      "\"last\"";
+  NdjsonParser parser(2);
+  std::vector<Document> docs;
+  auto results = parser.parse(input, docs);
+  ASSERT_EQ(results.size(), 3u);
+  ASSERT_EQ(docs.size(), 3u);
+  for (auto &result : results) EXPECT_EQ(result, ParseError::PARSE_OK);
+  EXPECT_EQ(docs[0]["a"].getInt32(), 1);
+  EXPECT_EQ(docs[1][1].getStringView(), "x\ny");
+  EXPECT_EQ(docs[2].getStringView(), "last");
+  EXPECT_EQ(parser.getRecords()[2], "\"last\"");
+
+  EXPECT_TRUE(parser.parse("", docs).empty());
+  EXPECT_TRUE(docs.empty());
+  EXPECT_EQ(parser.parse("1\n", docs).size(), 1u);
+}
+
+// 出错的记录不影响其他记录 偏移量相对于整个输入
+TEST(json_ndjson, error) {
+  std::string input = "{\"a\": 1}\n{\"a\": tru}\n[1] [2]\n{\"a\": 3}\n";
+  NdjsonParser parser(2);
+  std::vector<Document> docs;
+  auto results = parser.parse(input, docs);
+  ASSERT_EQ(results.size(), 4u);
+  EXPECT_EQ(results[0], ParseError::PARSE_OK);
+  EXPECT_EQ(results[1], ParseError::PARSE_BAD_VALUE);
+  EXPECT_EQ(results[1].getLine(input), 2u);
+  EXPECT_EQ(results[1].getOffset(), input.find("tru") + 3);
+  EXPECT_EQ(results[2], ParseError::PARSE_ROOT_NOT_SINGULAR);
+  EXPECT_EQ(results[2].getLine(input), 3u);
+  EXPECT_EQ(results[2].getColumn(input), 5u);
+  EXPECT_EQ(results[3], ParseError::PARSE_OK);
+  EXPECT_EQ(docs[3]["a"].getInt32(), 3);
+}
+
+// 记录较多时跨越多个批次 结果仍按输入顺序排列
+TEST(json_ndjson, order) {
+  std::ifstream in(GOA_JSON_DATA_DIR "/cart.json");
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  std::string record = buffer.str();
+  ASSERT_FALSE(record.empty());
+  record.erase(std::remove(record.begin(), record.end(), '\n'), record.end());
+
+  std::string input;
+  for (int i = 0; i < 200; i++) {
+    input += "{\"id\": " + std::to_string(i) + ", \"doc\": " + record + "}\n";
+    input += "[" + std::to_string(i) + "]\n";
+  }
+
+  // 只统计事件数的SAX handler
+  struct Counter {
+    bool Null() { return count(); }
+    bool Bool(bool) { return count(); }
+    bool Int32(int32_t) { return count(); }
+    bool Int64(int64_t) { return count(); }
+    bool Double(double) { return count(); }
+    bool String(std::string_view) { return count(); }
+    bool StartObject() { return count(); }
+    bool Key(std::string_view) { return count(); }
+    bool EndObject() { return count(); }
+    bool StartArray() { return count(); }
+    bool EndArray() { return count(); }
+    bool count() {
+      events++;
+      return true;
+    }
+    size_t events = 0;
+  };
+
+  for (size_t threads : {1, 4}) {
+    NdjsonParser parser(threads);
+    std::vector<Document> docs;
+    auto results = parser.parse(input, docs);
+    ASSERT_EQ(docs.size(), 400u);
+    for (int i = 0; i < 200; i++) {
+      ASSERT_EQ(results[2 * i], ParseError::PARSE_OK);
+      ASSERT_EQ(results[2 * i + 1], ParseError::PARSE_OK);
+      EXPECT_EQ(docs[2 * i]["id"].getInt32(), i);
+      EXPECT_EQ(docs[2 * i + 1][0].getInt32(), i);
+    }
+
+    std::vector<Counter> counters;
+    parser.parse(input, counters);
+    ASSERT_EQ(counters.size(), 400u);
+    for (int i = 0; i < 200; i++) {
+      EXPECT_EQ(counters[2 * i].events, counters[0].events);
+      EXPECT_EQ(counters[2 * i + 1].events, 3u);
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include <Document.hpp>
+#include <OnDemand.hpp>
+#include <fstream>
+#include <sstream>
+
+using namespace goa::json;
+
+TEST(ondemand, lookup) {
+  std::string json =
+      " {\"a\": 1, \"b\": {\"c\": [true, null, -2.5, \"x\"]},"
+      " \"big\": 12345678901, \"s\": \"hello\"} ";
+  OnDemandDocument doc(json);
+  EXPECT_EQ(doc["a"].getInt32(), 1);
+  EXPECT_EQ(doc["a"].getInt64(), 1);
+  EXPECT_EQ(doc["big"].getInt64(), 12345678901LL);
+  EXPECT_EQ(doc["big"].getType(), ValueType::TYPE_INT64);
+  EXPECT_EQ(doc["s"].getStringView(), "hello");
+  // 不含转义的字符串直接指向输入
+  EXPECT_EQ(doc["s"].getStringView().data(), json.data() + json.find("hello"));
+
+  auto c = doc["b"]["c"];
+  EXPECT_TRUE(c.isArray());
+  EXPECT_TRUE(c[size_t(0)].getBool());
+  EXPECT_TRUE(c[1].isNull());
+  EXPECT_EQ(c[2].getDouble(), -2.5);
+  EXPECT_EQ(c[3].getStringView(), "x");
+
+  // 不存在的key和下标
+  EXPECT_FALSE(doc["none"].exists());
+  EXPECT_FALSE(doc["none"]["deeper"].exists());
+  EXPECT_EQ(doc["none"].getError(), ParseError::PARSE_OK);
+  EXPECT_FALSE(c[4].exists());
+  EXPECT_FALSE(doc["a"]["c"].exists());
+}
+
+TEST(ondemand, escape) {
+  std::string json =
+      "{\"k\\\"ey\": \"v\\u00e9\\n\", \"t\": \"}]\\\\\", \"x\": 7}";
+  OnDemandDocument doc(json);
+  EXPECT_EQ(doc["k\"ey"].getStringView(), "v\xC3\xA9\n");
+  EXPECT_EQ(doc["t"].getStringView(), "}]\\");
+  EXPECT_EQ(doc["x"].getInt32(), 7);
+
+  // 反复读取同一个转义字符串 只解码保存一次
+  auto first = doc["k\"ey"].getStringView();
+  for (int i = 0; i < 100; i++)
+    EXPECT_EQ(doc["k\"ey"].getStringView().data(), first.data());
+}
+
+// 被跳过的值跨越多个64字节块 且字符串内含有括号和转义的引号
+TEST(ondemand, skip) {
+  std::string nested = "{\"s\": \"[{\\\"" + std::string(100, ']') +
+                       "\\\\\", \"a\": [[1, {}], [\"}\"]" +
+                       std::string(70, ' ') + "]}";
+  for (size_t pad = 0; pad < 64; pad++) {
+    std::string json = "{" + std::string(pad, ' ') + "\"skip\": " + nested +
+                       ", \"skip2\": [" + nested + "], \"v\": 42}";
+    OnDemandDocument doc(json);
+    ASSERT_EQ(doc["v"].getInt32(), 42) << pad;
+    EXPECT_EQ(doc["skip"]["a"][1][size_t(0)].getStringView(), "}");
+  }
+}
+
+TEST(ondemand, iterate) {
+  std::string json = "{\"a\": [1, 2, 3], \"b\\n\": {}, \"c\": \"x\"}";
+  OnDemandDocument doc(json);
+  int64_t sum = 0;
+  auto err = doc["a"].forEachElement([&](OnDemandValue v) {
+    sum += v.getInt64();
+    return true;
+  });
+  EXPECT_EQ(err, ParseError::PARSE_OK);
+  EXPECT_EQ(sum, 6);
+
+  std::string keys;
+  err = doc.getRoot().forEachMember([&](std::string_view k, OnDemandValue) {
+    keys += k;
+    return true;
+  });
+  EXPECT_EQ(err, ParseError::PARSE_OK);
+  EXPECT_EQ(keys, "ab\nc");
+}
+
+TEST(ondemand, error) {
+  auto find = [](const std::string &json, const char *key) {
+    OnDemandDocument doc(json);
+    return doc[key].getError();
+  };
+  EXPECT_EQ(find("", "a"), ParseError::PARSE_EXPECT_VALUE);
+  EXPECT_EQ(find("{1: 2}", "a"), ParseError::PARSE_MISS_KEY);
+  EXPECT_EQ(find("{\"a\" 2}", "a"), ParseError::PARSE_MISS_COLON);
+  EXPECT_EQ(find("{\"b\": [1, 2}", "a"),
+            ParseError::PARSE_MISS_COMMA_OR_CURLY_BRACKET);
+  EXPECT_EQ(find("{\"b\": 1 \"a\": 2}", "a"),
+            ParseError::PARSE_MISS_COMMA_OR_CURLY_BRACKET);
+  EXPECT_EQ(find("{\"a\": 01}", "a"), ParseError::PARSE_BAD_VALUE);
+  EXPECT_EQ(find("{\"a\": \"\\x\"}", "a"),
+            ParseError::PARSE_BAD_STRING_ESCAPE);
+  EXPECT_EQ(find("{\"a\": 1}", "a"), ParseError::PARSE_OK);
+}
+
+// 按需访问cart.json的每个值 结果应与Document完全一致
+void EXPECT_SAME(const Value &expect, OnDemandValue actual) {
+  ASSERT_TRUE(actual.exists());
+  ASSERT_EQ(expect.getType(), actual.getType());
+  switch (expect.getType()) {
+    case ValueType::TYPE_BOOL:
+      EXPECT_EQ(expect.getBool(), actual.getBool());
+      break;
+    case ValueType::TYPE_INT32:
+    case ValueType::TYPE_INT64:
+      EXPECT_EQ(expect.getInt64(), actual.getInt64());
+      break;
+    case ValueType::TYPE_DOUBLE:
+      EXPECT_EQ(expect.getDouble(), actual.getDouble());
+      break;
+    case ValueType::TYPE_STRING:
+      EXPECT_EQ(expect.getStringView(), actual.getStringView());
+      break;
+    case ValueType::TYPE_ARRAY:
+      for (size_t i = 0; i < expect.getSize(); i++)
+        EXPECT_SAME(expect[i], actual[i]);
+      EXPECT_FALSE(actual[expect.getSize()].exists());
+      break;
+    case ValueType::TYPE_OBJECT:
+      for (auto &member : expect.getObject())
+        EXPECT_SAME(member.value, actual[member.key.getStringView()]);
+      break;
+    default:
+      break;
+  }
+}
+
+TEST(ondemand, taobao) {
+  std::ifstream in(GOA_JSON_DATA_DIR "/cart.json");
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  std::string json = buffer.str();
+  ASSERT_FALSE(json.empty());
+
+  Document expect;
+  ASSERT_EQ(expect.parse(json), ParseError::PARSE_OK);
+  OnDemandDocument actual(json);
+  EXPECT_SAME(expect, actual.getRoot());
+  EXPECT_EQ(actual["data"]["hierarchy"]["root"].getStringView(), "global_1");
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,259 @@
+#include <gtest/gtest.h>
+
+#include <ParallelReader.hpp>
+#include <StringWriteStream.hpp>
+#include <Writer.hpp>
+#include <algorithm>
+#include <fstream>
+#include <memory_resource>
+#include <sstream>
+#include <vector>
+
+using namespace goa::json;
+
+inline std::string readCart() {
+  std::ifstream in(GOA_JSON_DATA_DIR "/cart.json");
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  return buffer.str();
+}
+
+// 由多份cart.json和若干小元素组成的大数组和大对象 足以切分成多批
+inline std::string makeArray(const std::string &cart, int copies) {
+  std::string json = "[\n";
+  for (int i = 0; i < copies; i++) {
+    if (i > 0) json += ",\n";
+    json += cart + ", " + std::to_string(i) + ", \"s,]}\\\"" +
+            std::to_string(i) + "\", [], {}";
+  }
+  return json + "\n] ";
+}
+
+inline std::string makeObject(const std::string &cart, int copies) {
+  std::string json = " {";
+  for (int i = 0; i < copies; i++) {
+    if (i > 0) json += ", ";
+    json += "\"cart" + std::to_string(i) + "\" : " + cart + ", \"n:" +
+            std::to_string(i) + "\": [" + std::to_string(i) + "]";
+  }
+  return json + "}";
+}
+
+// 用Writer记录事件序列
+inline std::string writeEvents(const std::string &json, ParseResult &result,
+                               bool parallel) {
+  StringWriteStream os;
+  Writer writer(os);
+  if (parallel) {
+    ParallelReader reader(4);
+    result = reader.parse(json, writer);
+  } else {
+    StringReadStream is(json);
+    result = Reader::parse(is, writer);
+  }
+  return std::string(os.getStringView());
+}
+
+inline std::string writeDocument(const Document &doc) {
+  StringWriteStream os;
+  Writer writer(os);
+  doc.writeTo(writer);
+  return std::string(os.getStringView());
+}
+
+inline void EXPECT_SAME_AS_READER(const std::string &json) {
+  // 出错时handler可能只收到部分事件 只比较错误
+  ParseResult expect, actual;
+  std::string events = writeEvents(json, actual, true);
+  if (writeEvents(json, expect, false) != events) {
+    EXPECT_NE(expect, ParseError::PARSE_OK);
+  }
+  EXPECT_EQ(actual, expect.err());
+  EXPECT_EQ(actual.getOffset(), expect.getOffset());
+
+  Document full, doc;
+  expect = full.parse(json);
+  ParallelReader reader(4);
+  actual = reader.parse(json, doc);
+  EXPECT_EQ(actual, expect.err());
+  EXPECT_EQ(actual.getOffset(), expect.getOffset());
+  if (expect == ParseError::PARSE_OK) {
+    EXPECT_EQ(writeDocument(doc), writeDocument(full));
+  }
+}
+
+TEST(json_parallel, array) {
+  std::string cart = readCart();
+  ASSERT_FALSE(cart.empty());
+  std::string json = makeArray(cart, 30);
+  EXPECT_SAME_AS_READER(json);
+
+  ParallelReader reader(4);
+  Document doc;
+  ASSERT_EQ(reader.parse(json, doc), ParseError::PARSE_OK);
+  ASSERT_EQ(doc.getSize(), 150u);
+  for (size_t i = 0; i < 30; i++) {
+    EXPECT_EQ(doc[5 * i + 1].getInt32(), static_cast<int32_t>(i));
+    EXPECT_EQ(doc[5 * i + 2].getString(), "s,]}\"" + std::to_string(i));
+  }
+}
+
+TEST(json_parallel, object) {
+  std::string cart = readCart();
+  std::string json = makeObject(cart, 30);
+  EXPECT_SAME_AS_READER(json);
+
+  ParallelReader reader(3);
+  Document doc;
+  ASSERT_EQ(reader.parse(json, doc), ParseError::PARSE_OK);
+  ASSERT_EQ(doc.getSize(), 60u);
+  EXPECT_EQ(doc["n:29"][0].getInt32(), 29);
+}
+
+// 记录经过的分配和释放次数
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  size_t allocated = 0, deallocated = 0;
+
+ private:
+  void *do_allocate(size_t bytes, size_t alignment) override {
+    allocated++;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+    deallocated++;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+};
+
+// 元素沿用目标Document的引用计数方式 指定了resource时所有节点都从它分配
+TEST(json_parallel, document_options) {
+  std::string json = makeArray(readCart(), 30);
+  Document expect;
+  ASSERT_EQ(expect.parse(json), ParseError::PARSE_OK);
+
+  ParallelReader reader(4);
+  Document local(RefCountPolicy::LOCAL);
+  ASSERT_EQ(reader.parse(json, local), ParseError::PARSE_OK);
+  EXPECT_EQ(writeDocument(local), writeDocument(expect));
+
+  CountingResource counting, serial;
+  {
+    Document doc(&counting), reference(&serial);
+    ASSERT_EQ(reader.parse(json, doc), ParseError::PARSE_OK);
+    ASSERT_EQ(reference.parse(json), ParseError::PARSE_OK);
+    EXPECT_EQ(writeDocument(doc), writeDocument(expect));
+  }
+  EXPECT_EQ(counting.allocated, serial.allocated);
+  EXPECT_EQ(counting.allocated, counting.deallocated);
+  Document arena = Document::withArena();
+  ASSERT_EQ(reader.parse(json, arena), ParseError::PARSE_OK);
+  EXPECT_EQ(writeDocument(arena), writeDocument(expect));
+}
+
+// 小输入和非容器直接交给Reader
+TEST(json_parallel, small) {
+  for (std::string json : {"1", " [] ", "{}", "[1, 2]", "", "[1,", "\"x\""})
+    EXPECT_SAME_AS_READER(json);
+}
+
+// 任意位置出错时 错误码和位置与Reader相同
+TEST(json_parallel, error) {
+  std::string cart = readCart();
+  std::string array = makeArray(cart, 30);
+  std::string object = makeObject(cart, 30);
+  size_t middle = array.size() / 2;
+
+  EXPECT_SAME_AS_READER(array.substr(0, middle));
+  EXPECT_SAME_AS_READER(array + "x");
+  EXPECT_SAME_AS_READER(array.substr(0, array.rfind(']')) + "}");
+  EXPECT_SAME_AS_READER(array.substr(0, array.rfind(']')) + ",]");
+  EXPECT_SAME_AS_READER(array.substr(0, middle) + ",," +
+                        array.substr(middle));
+  EXPECT_SAME_AS_READER(array.substr(0, middle) + "tru" +
+                        array.substr(middle));
+  std::string bad = array;
+  bad.replace(bad.find("\"s,]}"), 1, "x");
+  EXPECT_SAME_AS_READER(bad);
+
+  EXPECT_SAME_AS_READER(object.substr(0, object.size() / 2));
+  bad = object;
+  bad.replace(bad.rfind("\"n:"), 5, "1234");
+  EXPECT_SAME_AS_READER(bad);
+  bad = object;
+  bad.replace(bad.rfind(" : "), 3, "   ");
+  EXPECT_SAME_AS_READER(bad);
+
+  // 元素的嵌套层数加上顶层数组超过限制
+  for (size_t depth : {ParseStack::kDefaultMaxDepth - 1,
+                       ParseStack::kDefaultMaxDepth}) {
+    std::string deep = array;
+    deep.insert(middle, std::string(depth, '[') + std::string(depth, ']') +
+                            ",");
+    deep.insert(deep.find("\"s,]}"), ",");
+    EXPECT_SAME_AS_READER(deep);
+  }
+}
+
+// 嵌套对象中的key同样以KeyId事件发出 与Reader相同
+struct KeyIdWriter : Writer<StringWriteStream> {
+  using Writer::Writer;
+  const KeyDictionary &getKeyDictionary() const { return dict; }
+  bool KeyId(size_t id, std::string_view key) {
+    ids.push_back(id);
+    return Key(key);
+  }
+  KeyDictionary dict{"id", "tag", "fields", "n:29"};
+  std::vector<size_t> ids;
+};
+
+TEST(json_parallel, key_dictionary) {
+  std::string json = makeObject(readCart(), 30);
+  StringWriteStream expectOs, actualOs;
+  KeyIdWriter expect(expectOs), actual(actualOs);
+  StringReadStream is(json);
+  ASSERT_EQ(Reader::parse(is, expect), ParseError::PARSE_OK);
+  ParallelReader reader(4);
+  ASSERT_EQ(reader.parse(json, actual), ParseError::PARSE_OK);
+  EXPECT_EQ(actualOs.getStringView(), expectOs.getStringView());
+  EXPECT_EQ(actual.ids, expect.ids);
+  EXPECT_GT(std::count(actual.ids.begin(), actual.ids.end(), 0u), 30);
+}
+
+// 事件发出后输入被改动 切分结果失效 后一轮的元素解析失败而整体仍然合法
+// 已发出的事件无法撤回 不能返回PARSE_OK
+struct MutatingWriter : Writer<StringWriteStream> {
+  MutatingWriter(StringWriteStream &os, std::string &json)
+      : Writer(os), json_(json) {}
+  bool StartArray() {
+    if (!mutated_) json_.replace(json_.rfind("123, 45"), 7, "1, 2345");
+    mutated_ = true;
+    return Writer::StartArray();
+  }
+  std::string &json_;
+  bool mutated_ = false;
+};
+
+TEST(json_parallel, later_wave_error) {
+  std::string json = makeArray(readCart(), 30);
+  json.insert(json.rfind(']'), ", 123, 45");
+  StringWriteStream os;
+  MutatingWriter writer(os, json);
+  ParallelReader reader(4);
+  ParseResult result = reader.parse(json, writer);
+  EXPECT_EQ(result, ParseError::PARSE_BAD_VALUE);
+  EXPECT_GT(result.getOffset(), 0u);
+  EXPECT_LT(result.getOffset(), json.rfind("1, 2345"));
+  EXPECT_FALSE(os.getStringView().empty());
+
+  StringReadStream is(json);
+  EXPECT_EQ(Reader::validate(is), ParseError::PARSE_OK);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include <PushParser.hpp>
+#include <StringWriteStream.hpp>
+#include <Writer.hpp>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+using namespace goa::json;
+
+// 用Writer记录事件序列 与Reader一次解析的结果比较
+inline std::string parseWhole(const std::string &json, ParseResult &result) {
+  StringWriteStream os;
+  Writer writer(os);
+  StringReadStream is(json);
+  result = Reader::parse(is, writer);
+  return std::string(os.getStringView());
+}
+
+// 按给定的长度切分输入 逐段feed
+inline std::string parseChunked(const std::string &json, size_t chunk,
+                                ParseResult &result) {
+  StringWriteStream os;
+  Writer writer(os);
+  PushParser<Writer<StringWriteStream>> parser(writer);
+  for (size_t i = 0; i < json.size(); i += chunk) {
+    result = parser.feed(std::string_view(json).substr(i, chunk));
+    if (result != ParseError::PARSE_OK) break;
+  }
+  result = parser.finish();
+  return std::string(os.getStringView());
+}
+
+inline void EXPECT_SAME_AS_READER(const std::string &json, size_t chunk) {
+  ParseResult expect, actual;
+  std::string events = parseWhole(json, expect);
+  EXPECT_EQ(parseChunked(json, chunk, actual), events)
+      << json << " chunk=" << chunk;
+  EXPECT_EQ(actual, expect.err()) << json << " chunk=" << chunk;
+  EXPECT_EQ(actual.getOffset(), expect.getOffset())
+      << json << " chunk=" << chunk;
+}
+
+TEST(json_push, chunked) {
+  for (std::string json :
+       {"{\"a\": [1, -2.5e3, \"x\\n\\u00e9\", true, null, {}], \"b\": {}}",
+        " [ [ ] , { } , [ 1 ] ] ", "123", "-0.5e-3 ", "\"str\\\"ing\"",
+        "true", "null", "[NaN, Infinity, 1i64, -7i32]",
+        "{\"k\\\\\": \"\\ud83d\\ude00\"}"}) {
+    for (size_t chunk = 1; chunk <= json.size(); chunk++)
+      EXPECT_SAME_AS_READER(json, chunk);
+  }
+}
+
+// 错误码和出错位置与Reader一致 与输入如何切分无关
+TEST(json_push, error) {
+  for (std::string json :
+       {"", "  ", "[1, 2", "{\"a\" 1}", "{1: 2}", "[1,]", "01", "-", "1.",
+        "1e", "tru", "nul", "\"\\x\"", "\"\\ud800\"", "\"\x01\"", "\"abc",
+        "1e400", "99999999999999999999", "[1] 2", "{\"a\": 1 \"b\"}",
+        "[1 2]", "{\"a\"", "[", "{", "[1.5i64]", "[12abc]"}) {
+    for (size_t chunk = 1; chunk <= json.size() + 1; chunk++)
+      EXPECT_SAME_AS_READER(json, chunk);
+  }
+}
+
+// 解析选项与Reader::parse的相同
+TEST(json_push, flags) {
+  constexpr unsigned kFlags = kParseStrictFlags | kParseValidateUtf8Flag;
+  for (std::string json : {"[1, NaN]", "[-Infinity]", "{\"a\": 7i32}",
+                           "[\"\xc3\x28\"]", "[1.5, \"\xc3\xa9\"]"}) {
+    StringWriteStream os1, os2;
+    Writer whole(os1), chunked(os2);
+    StringReadStream is(json);
+    ParseResult expect = Reader::parse<kFlags>(is, whole);
+    PushParser<Writer<StringWriteStream>, kFlags> parser(chunked);
+    for (size_t i = 0; i < json.size(); i += 3)
+      parser.feed(std::string_view(json).substr(i, 3));
+    ParseResult actual = parser.finish();
+    EXPECT_EQ(actual, expect.err()) << json;
+    EXPECT_EQ(actual.getOffset(), expect.getOffset()) << json;
+    EXPECT_EQ(os2.getStringView(), os1.getStringView()) << json;
+  }
+}
+
+TEST(json_push, depth) {
+  StringWriteStream os;
+  Writer writer(os);
+  PushParser<Writer<StringWriteStream>> parser(writer, 3);
+  EXPECT_EQ(parser.feed("[[["), ParseError::PARSE_OK);
+  ParseResult result = parser.feed("[");
+  EXPECT_EQ(result, ParseError::PARSE_DEPTH_EXCEEDED);
+  EXPECT_EQ(result.getOffset(), 3u);
+  // 出错后不再解析
+  EXPECT_EQ(parser.feed("]]]]"), ParseError::PARSE_DEPTH_EXCEEDED);
+}
+
+// 预算用尽时暂停 resume后继续 结果与一次解析相同
+TEST(json_push, budget) {
+  std::string json = "[";
+  for (int i = 0; i < 1000; i++) json += std::to_string(i) + ",";
+  json += "\"end\"]";
+  ParseResult expect;
+  std::string events = parseWhole(json, expect);
+
+  StringWriteStream os;
+  Writer writer(os);
+  PushParser<Writer<StringWriteStream>> parser(writer);
+  ParseBudget budget;
+  budget.bytes = 100;
+  ParseResult result = parser.feed(json, budget);
+  EXPECT_TRUE(parser.isPaused());
+  EXPECT_GE(result.getOffset(), 100u);
+  EXPECT_LT(result.getOffset(), 110u);
+  int rounds = 1;
+  while (parser.isPaused()) {
+    ASSERT_EQ(parser.resume(budget), ParseError::PARSE_OK);
+    rounds++;
+  }
+  EXPECT_GE(rounds, static_cast<int>(json.size() / 110));
+  EXPECT_EQ(parser.finish(), ParseError::PARSE_OK);
+  EXPECT_EQ(std::string(os.getStringView()), events);
+
+  // 时间预算为0时 每次至少前进一个token
+  StringWriteStream os2;
+  Writer writer2(os2);
+  PushParser<Writer<StringWriteStream>> parser2(writer2);
+  budget = ParseBudget();
+  budget.time = std::chrono::nanoseconds(0);
+  parser2.feed(json, budget);
+  EXPECT_TRUE(parser2.isPaused());
+  while (parser2.isPaused()) parser2.resume(budget);
+  EXPECT_EQ(parser2.finish(), ParseError::PARSE_OK);
+  EXPECT_EQ(std::string(os2.getStringView()), events);
+}
+
+TEST(json_push, taobao) {
+  std::ifstream in(GOA_JSON_DATA_DIR "/cart.json");
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  std::string json = buffer.str();
+  ASSERT_FALSE(json.empty());
+
+  std::mt19937 rng(20240601);
+  for (size_t chunk : {1, 7, 64, 1000, 4096}) {
+    EXPECT_SAME_AS_READER(json, chunk);
+  }
+  // 长度随机的分段
+  ParseResult expect;
+  std::string events = parseWhole(json, expect);
+  StringWriteStream os;
+  Writer writer(os);
+  PushParser<Writer<StringWriteStream>> parser(writer);
+  for (size_t i = 0; i < json.size();) {
+    size_t n = rng() % 300;
+    ASSERT_EQ(parser.feed(std::string_view(json).substr(i, n)),
+              ParseError::PARSE_OK);
+    i += n;
+  }
+  EXPECT_EQ(parser.finish(), ParseError::PARSE_OK);
+  EXPECT_EQ(std::string(os.getStringView()), events);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
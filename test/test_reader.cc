@@ -0,0 +1,411 @@
+#include <gtest/gtest.h>
+
+#include <Reader.hpp>
+#include <StringReadStream.hpp>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace goa::json;
+
+// 只记录字符串和key 用于检查Reader交给handler的内容
+class StringCollector : noncopyable {
+ public:
+  bool Null() { return true; }
+  bool Bool(bool) { return true; }
+  bool Int32(int32_t) { return true; }
+  bool Int64(int64_t) { return true; }
+  bool Double(double) { return true; }
+  bool String(std::string_view s) {
+    views.push_back(s);
+    strings.emplace_back(s);
+    return true;
+  }
+  bool StartObject() { return true; }
+  bool Key(std::string_view s) { return String(s); }
+  bool EndObject() { return true; }
+  bool StartArray() { return true; }
+  bool EndArray() { return true; }
+
+  std::vector<std::string_view> views;
+  std::vector<std::string> strings;
+};
+
+inline bool pointsInto(std::string_view s, const std::string &json) {
+  return s.data() >= json.data() &&
+         s.data() + s.size() <= json.data() + json.size();
+}
+
+TEST(json_reader, zero_copy_string) {
+  std::string json =
+      "{\"short\":\"a\",\"long\":\"" + std::string(100, 'x') +
+      "\",\"empty\":\"\",\"utf8\":\"蛤蛤蛤\"}";
+  StringCollector handler;
+  StringReadStream is(json);
+  ASSERT_EQ(Reader::parse(is, handler), ParseError::PARSE_OK);
+  ASSERT_EQ(handler.views.size(), 8u);
+  // 不含转义的字符串直接指向输入
+  for (auto s : handler.views) EXPECT_TRUE(pointsInto(s, json));
+  EXPECT_EQ(handler.strings[3], std::string(100, 'x'));
+  EXPECT_EQ(handler.strings[7], "蛤蛤蛤");
+}
+
+TEST(json_reader, escaped_string) {
+  std::string json = "[\"" + std::string(40, 'a') + "\\n" +
+                     std::string(40, 'b') + "\\u00e9\\ud83d\\ude00\\\"\"]";
+  StringCollector handler;
+  StringReadStream is(json);
+  ASSERT_EQ(Reader::parse(is, handler), ParseError::PARSE_OK);
+  ASSERT_EQ(handler.strings.size(), 1u);
+  EXPECT_EQ(handler.strings[0], std::string(40, 'a') + "\n" +
+                                    std::string(40, 'b') +
+                                    "\xC3\xA9\xF0\x9F\x98\x80\"");
+}
+
+TEST(json_reader, string_error) {
+  auto parse = [](const std::string &json) {
+    StringCollector handler;
+    StringReadStream is(json);
+    return Reader::parse(is, handler);
+  };
+  EXPECT_EQ(parse("\"abc"), ParseError::PARSE_MISS_QUOTATION_MARK);
+  EXPECT_EQ(parse("\"abc\\n"), ParseError::PARSE_MISS_QUOTATION_MARK);
+  EXPECT_EQ(parse("\"" + std::string(50, 'a') + "\x01\""),
+            ParseError::PARSE_BAD_STRING_CHAR);
+  EXPECT_EQ(parse("\"\\v\""), ParseError::PARSE_BAD_STRING_ESCAPE);
+  EXPECT_EQ(parse("\"\\u12G4\""), ParseError::PARSE_BAD_UNICODE_HEX);
+  EXPECT_EQ(parse("\"\\uD800\\u0041\""),
+            ParseError::PARSE_BAD_UNICODE_SURROGATE);
+}
+
+// 只记录数字 用于检查数字解析的类型和值
+class NumberCollector : noncopyable {
+ public:
+  bool Null() { return true; }
+  bool Bool(bool) { return true; }
+  bool Int32(int32_t i) { return record(ValueType::TYPE_INT32, i, 0); }
+  bool Int64(int64_t i) { return record(ValueType::TYPE_INT64, i, 0); }
+  bool Double(double v) { return record(ValueType::TYPE_DOUBLE, 0, v); }
+  bool String(std::string_view) { return true; }
+  bool StartObject() { return true; }
+  bool Key(std::string_view) { return true; }
+  bool EndObject() { return true; }
+  bool StartArray() { return true; }
+  bool EndArray() { return true; }
+
+  ValueType type = ValueType::TYPE_NULL;
+  int64_t i64 = 0;
+  double d = 0;
+
+ private:
+  bool record(ValueType t, int64_t i, double v) {
+    type = t;
+    i64 = i;
+    d = v;
+    return true;
+  }
+};
+
+inline ParseError parseNumber(const std::string &json,
+                              NumberCollector &handler) {
+  StringReadStream is(json);
+  return Reader::parse(is, handler);
+}
+
+TEST(json_reader, integer) {
+  auto expect = [](const std::string &json, ValueType type, int64_t i) {
+    NumberCollector handler;
+    ASSERT_EQ(parseNumber(json, handler), ParseError::PARSE_OK) << json;
+    EXPECT_EQ(handler.type, type) << json;
+    EXPECT_EQ(handler.i64, i) << json;
+  };
+  expect("0", ValueType::TYPE_INT32, 0);
+  expect("-0", ValueType::TYPE_INT32, 0);
+  expect("2147483647", ValueType::TYPE_INT32, INT32_MAX);
+  expect("-2147483648", ValueType::TYPE_INT32, INT32_MIN);
+  expect("2147483648", ValueType::TYPE_INT64, 2147483648LL);
+  expect("9223372036854775807", ValueType::TYPE_INT64, INT64_MAX);
+  expect("-9223372036854775808", ValueType::TYPE_INT64, INT64_MIN);
+  expect("1i64", ValueType::TYPE_INT64, 1);
+  expect("-5i32", ValueType::TYPE_INT32, -5);
+
+  NumberCollector handler;
+  for (auto json : {"9223372036854775808", "-9223372036854775809",
+                    "12345678901234567890", "2147483648i32"}) {
+    EXPECT_EQ(parseNumber(json, handler), ParseError::PARSE_NUMBER_TOO_BIG)
+        << json;
+  }
+}
+
+TEST(json_reader, double_) {
+  // 以strtod的结果为准 覆盖快速路径和from_chars两条路径
+  auto expect = [](const std::string &json) {
+    NumberCollector handler;
+    ASSERT_EQ(parseNumber(json, handler), ParseError::PARSE_OK) << json;
+    EXPECT_EQ(handler.type, ValueType::TYPE_DOUBLE) << json;
+    EXPECT_EQ(handler.d, std::strtod(json.c_str(), nullptr)) << json;
+  };
+  for (auto json : {"0.0", "-0.0", "1.5", "0.1", "-123.456e-7", "1e22", "1e23",
+                    "9007199254740993.0", "123456789012345678901234.5",
+                    "0.000000000000000000000000000001",
+                    "1.7976931348623157e308",
+                    "4.9406564584124654e-324", "2.2250738585072011e-308",
+                    "7.3177701707893310e+15", "0e1000"}) {
+    expect(json);
+  }
+
+  std::mt19937_64 rng(20240601);
+  for (int i = 0; i < 20000; i++) {
+    auto digits = std::to_string(rng() >> (rng() % 64));
+    auto frac = rng() % (digits.size() + 1);
+    digits.insert(digits.size() - frac, ".");
+    if (digits[0] == '.') digits.insert(0, "0");
+    if (digits.back() == '.') digits += "0";
+    int exp = static_cast<int>(rng() % 80) - 40;
+    expect(digits + "e" + std::to_string(exp));
+  }
+
+  NumberCollector handler;
+  EXPECT_EQ(parseNumber("1e309", handler), ParseError::PARSE_NUMBER_TOO_BIG);
+  EXPECT_EQ(parseNumber("1e-400", handler),
+            ParseError::PARSE_NUMBER_TOO_BIG);
+  EXPECT_EQ(parseNumber("1.5i64", handler), ParseError::PARSE_BAD_VALUE);
+}
+
+TEST(json_reader, depth) {
+  auto nested = [](size_t depth) {
+    return std::string(depth, '[') + std::string(depth, ']');
+  };
+  StringCollector handler;
+
+  // 远超限制的嵌套不会耗尽线程栈
+  std::string deep(100000, '[');
+  StringReadStream is(deep);
+  EXPECT_EQ(Reader::parse(is, handler), ParseError::PARSE_DEPTH_EXCEEDED);
+
+  ParseStack stack(3);
+  for (int i = 0; i < 2; i++) {
+    auto ok = nested(3), bad = nested(4);
+    StringReadStream is1(ok), is2(bad);
+    EXPECT_EQ(Reader::parse(is1, handler, stack), ParseError::PARSE_OK);
+    EXPECT_EQ(Reader::parse(is2, handler, stack),
+              ParseError::PARSE_DEPTH_EXCEEDED);
+  }
+  std::string object = "[[{\"a\":{}}]]";
+  StringReadStream is3(object);
+  EXPECT_EQ(Reader::parse(is3, handler, stack),
+            ParseError::PARSE_DEPTH_EXCEEDED);
+}
+
+TEST(json_reader, error_location) {
+  auto parse = [](const std::string &json) {
+    StringCollector handler;
+    StringReadStream is(json);
+    return Reader::parse(is, handler);
+  };
+  std::string json = "{\n  \"a\": [1, 2],\n  \"b\": tru\n}";
+  ParseResult result = parse(json);
+  EXPECT_EQ(result, ParseError::PARSE_BAD_VALUE);
+  EXPECT_EQ(result.getOffset(), json.find("tru") + 3);
+  EXPECT_EQ(result.getLine(json), 3u);
+  EXPECT_EQ(result.getColumn(json), 11u);
+
+  result = parse("[1, 2");
+  EXPECT_EQ(result, ParseError::PARSE_MISS_COMMA_OR_SQUARE_BRACKET);
+  EXPECT_EQ(result.getOffset(), 5u);
+  EXPECT_EQ(result.getLine("[1, 2"), 1u);
+  EXPECT_EQ(result.getColumn("[1, 2"), 6u);
+
+  result = parse(" [] ");
+  EXPECT_EQ(result, ParseError::PARSE_OK);
+  EXPECT_EQ(result.getOffset(), 4u);
+
+  // 缺少分隔符时指向出错的字符本身 而不是它之后
+  result = parse("{\"a\" 1}");
+  EXPECT_EQ(result, ParseError::PARSE_MISS_COLON);
+  EXPECT_EQ(result.getOffset(), 5u);
+  result = parse("[1 2]");
+  EXPECT_EQ(result, ParseError::PARSE_MISS_COMMA_OR_SQUARE_BRACKET);
+  EXPECT_EQ(result.getOffset(), 3u);
+  json = "{\"a\": 1,\n \"b\": 2 \"c\": 3}";
+  result = parse(json);
+  EXPECT_EQ(result, ParseError::PARSE_MISS_COMMA_OR_CURLY_BRACKET);
+  EXPECT_EQ(result.getOffset(), json.find("\"c\""));
+  EXPECT_EQ(result.getLine(json), 2u);
+  EXPECT_EQ(result.getColumn(json), 9u);
+}
+
+// validate与完整解析的错误码和出错位置相同
+TEST(json_reader, validate) {
+  for (std::string json :
+       {"{\"a\": [1, -2.5e3, \"x\\n\", true, null, {}]}", " [] ", "\"\"",
+        "", "[1, 2", "{\"a\" 1}", "{1: 2}", "[1,]", "01", "-", "1.", "1e",
+        "tru", "nul", "\"\\x\"", "\"\\ud800\"", "\"\x01\"", "\"abc",
+        "1e400", "1e-400", "99999999999999999999", "[1] 2", "1.5e300"}) {
+    StringCollector handler;
+    StringReadStream is1(json), is2(json);
+    ParseResult expect = Reader::parse(is1, handler);
+    ParseResult actual = Reader::validate(is2);
+    EXPECT_EQ(actual, expect.err()) << json;
+    EXPECT_EQ(actual.getOffset(), expect.getOffset()) << json;
+  }
+
+  ParseStack stack(2);
+  std::string json = "[[[]]]";
+  StringReadStream is(json);
+  EXPECT_EQ(Reader::validate(is, stack), ParseError::PARSE_DEPTH_EXCEEDED);
+}
+
+// 严格模式只接受RFC 8259 扩展写法报错 其余与默认选项相同
+TEST(json_reader, flags) {
+  for (std::string json : {"NaN", "Infinity", "[1, NaN]", "1i32", "-5i64",
+                           "[1i64, 2]", "{\"a\": 1i32}"}) {
+    NumberCollector handler;
+    StringReadStream is1(json), is2(json), is3(json);
+    EXPECT_EQ(Reader::parse(is1, handler), ParseError::PARSE_OK) << json;
+    EXPECT_NE(Reader::parse<kParseStrictFlags>(is2, handler),
+              ParseError::PARSE_OK)
+        << json;
+    EXPECT_NE(Reader::validate<kParseStrictFlags>(is3), ParseError::PARSE_OK)
+        << json;
+  }
+  for (std::string json : {"Infinity", "[NaN, 1]"}) {
+    NumberCollector handler;
+    StringReadStream is(json);
+    EXPECT_EQ(Reader::parse<kParseNanAndInfFlag>(is, handler),
+              ParseError::PARSE_OK)
+        << json;
+  }
+  NumberCollector suffix;
+  StringReadStream suffixed("1i32"), nanArray("[NaN]");
+  EXPECT_EQ(Reader::parse<kParseNumberSuffixFlag>(suffixed, suffix),
+            ParseError::PARSE_OK);
+  EXPECT_EQ(Reader::parse<kParseNumberSuffixFlag>(nanArray, suffix),
+            ParseError::PARSE_BAD_VALUE);
+
+  for (std::string json : {"{\"a\": [1, -2.5e3, \"x\", true, null]}", "-0",
+                           "1.5e300", "[1] 2", "01", "1e", "tru"}) {
+    NumberCollector handler;
+    StringReadStream is1(json), is2(json);
+    ParseResult expect = Reader::parse(is1, handler);
+    ParseResult actual = Reader::parse<kParseStrictFlags>(is2, handler);
+    EXPECT_EQ(actual, expect.err()) << json;
+    EXPECT_EQ(actual.getOffset(), expect.getOffset()) << json;
+  }
+}
+
+// 开启校验后 不合法的UTF-8报PARSE_BAD_UTF8 合法的字符串内容不变
+TEST(json_reader, utf8) {
+  constexpr unsigned kFlags = kParseDefaultFlags | kParseValidateUtf8Flag;
+  std::string longText(100, 'x');
+  for (const std::string &json : std::vector<std::string>{
+           "[\"abc\", \"\xe8\x9b\xa4\xe8\x9b\xa4\"]",
+           "{\"\xc3\xa9\": \"\xf0\x9f\x98\x80\\n\xf4\x8f\xbf\xbf\"}",
+           "\"" + longText + "\xe4\xb8\xad" + longText + "\\u00e9\xe4\xb8\xad\"",
+           "\"\xef\xbb\xbf\""}) {
+    StringCollector expect, actual;
+    StringReadStream is1(json), is2(json);
+    ASSERT_EQ(Reader::parse(is1, expect), ParseError::PARSE_OK) << json;
+    ASSERT_EQ(Reader::parse<kFlags>(is2, actual), ParseError::PARSE_OK)
+        << json;
+    EXPECT_EQ(actual.strings, expect.strings);
+  }
+
+  for (std::string bad :
+       {"\xc0\x80", "\xed\xa0\x80", "\xf4\x90\x80\x80", "\x80", "\xff",
+        "\xe4\xb8", "\xe4\xb8x"}) {
+    for (const std::string &json : std::vector<std::string>{
+             "\"" + bad + "\"", "[\"" + longText + bad + "\"]",
+             "{\"" + bad + "\": 1}", "\"\\n" + bad + "\""}) {
+      StringCollector handler;
+      StringReadStream is1(json), is2(json), is3(json);
+      EXPECT_EQ(Reader::parse(is1, handler), ParseError::PARSE_OK) << json;
+      EXPECT_EQ(Reader::parse<kFlags>(is2, handler), ParseError::PARSE_BAD_UTF8)
+          << json;
+      EXPECT_EQ(Reader::validate<kFlags>(is3), ParseError::PARSE_BAD_UTF8)
+          << json;
+    }
+  }
+}
+
+TEST(json_reader, key_dictionary) {
+  // 长度和首尾8个字节都相同的key散列必然冲突 仍能区分
+  std::vector<std::string> keys = {"id", "", "tag", "a", "id"};
+  for (int i = 0; i < 300; i++)
+    keys.push_back("prefix__" + std::to_string(i) + "__suffix");
+  KeyDictionary dict(keys);
+  EXPECT_EQ(dict.getSize(), keys.size());
+  EXPECT_EQ(dict.find("id"), 0u);
+  EXPECT_EQ(dict.find(""), 1u);
+  EXPECT_EQ(dict.find("a"), 3u);
+  for (size_t i = 5; i < keys.size(); i++) EXPECT_EQ(dict.find(keys[i]), i);
+  for (std::string key : {"i", "ids", "b", "tah", "prefix__300__suffix"})
+    EXPECT_EQ(dict.find(key), KeyDictionary::kUnknown) << key;
+
+  // handler提供字典时 Reader以KeyId代替Key 包括含转义的key和按路径过滤时
+  struct KeyIdCollector : StringCollector {
+    const KeyDictionary &getKeyDictionary() const { return dict; }
+    bool KeyId(size_t id, std::string_view key) {
+      ids.push_back(id);
+      return String(key);
+    }
+    KeyDictionary dict{"id", "title", "sku"};
+    std::vector<size_t> ids;
+  } handler;
+  std::string json =
+      "{\"title\": \"t\", \"x\": {\"id\": 1}, \"i\\u0064\": 2, \"sku\": []}";
+  StringReadStream is(json);
+  ASSERT_EQ(Reader::parse(is, handler), ParseError::PARSE_OK);
+  EXPECT_EQ(handler.ids, (std::vector<size_t>{1, KeyDictionary::kUnknown, 0,
+                                               0, 2}));
+  ASSERT_EQ(handler.strings.size(), 6u);
+  EXPECT_EQ(handler.strings[4], "id");
+  EXPECT_EQ(handler.strings[5], "sku");
+
+  handler.ids.clear();
+  StringReadStream is2(json);
+  ASSERT_EQ(Reader::parse(is2, handler, PathFilter{"/x/id"}),
+            ParseError::PARSE_OK);
+  EXPECT_EQ(handler.ids, (std::vector<size_t>{KeyDictionary::kUnknown, 0}));
+}
+
+// handler提供skipValue时 被跳过的值不产生事件 其中的语法错误照常报告
+TEST(json_reader, skip_value) {
+  struct Skipper : StringCollector {
+    bool skipValue() const { return strings.back() == "skip"; }
+  } handler;
+  std::string json =
+      "{\"skip\": {\"a\": [\"b\"]}, \"keep\": \"c\", \"skip\": \"d\"}";
+  StringReadStream is(json);
+  ASSERT_EQ(Reader::parse(is, handler), ParseError::PARSE_OK);
+  EXPECT_EQ(handler.strings,
+            (std::vector<std::string>{"skip", "keep", "c", "skip"}));
+
+  for (std::string bad : {"{\"skip\": [1, }", "{\"skip\": \"\\x\"}",
+                          "{\"skip\": 1e400}", "{\"skip\": [[]"}) {
+    StringReadStream is1(bad), is2(bad);
+    ParseResult expect = Reader::validate(is1);
+    ParseResult actual = Reader::parse(is2, handler);
+    EXPECT_NE(expect, ParseError::PARSE_OK) << bad;
+    EXPECT_EQ(actual, expect.err()) << bad;
+    EXPECT_EQ(actual.getOffset(), expect.getOffset()) << bad;
+  }
+}
+
+// 返回false的handler 解析应在第一个事件后停止
+TEST(json_reader, user_stopped) {
+  struct Stopper : StringCollector {
+    bool StartArray() { return false; }
+  } handler;
+  std::string json = "[1, 2, 3]";
+  StringReadStream is(json);
+  ParseResult result = Reader::parse(is, handler);
+  EXPECT_EQ(result, ParseError::PARSE_USER_STOPPED);
+  EXPECT_EQ(result.getOffset(), 0u);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <SimdKernels.hpp>
+#include <random>
+#include <string>
+
+using namespace goa::json;
+
+// 以scalar版本为准 比较当前CPU支持的每一级SIMD内核
+class SimdKernelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::mt19937 rng(20240601);
+    // 偏向JSON中常见的字符 使各种分支都有机会命中
+    const char alphabet[] = "  \t\r\n09aZ\"\\{}[]:,-.e\x01\x1f\x7f\x80\xe4";
+    for (int i = 0; i < 4096; i++) {
+      input_.push_back(alphabet[rng() % (sizeof(alphabet) - 1)]);
+      // 制造较长的同类字符串 覆盖整块都不命中的情况
+      if (rng() % 64 == 0) input_.append(rng() % 100, ' ');
+      if (rng() % 64 == 0) input_.append(rng() % 100, '7');
+      if (rng() % 64 == 0) input_.append(rng() % 100, 'x');
+    }
+  }
+
+  std::vector<simd::SimdLevel> supportedLevels() const {
+    std::vector<simd::SimdLevel> levels;
+    for (auto level : {simd::SimdLevel::SSE42, simd::SimdLevel::AVX2,
+                       simd::SimdLevel::AVX512}) {
+      if (level <= simd::detectSimdLevel()) levels.push_back(level);
+    }
+    return levels;
+  }
+
+  std::string input_;
+};
+
+TEST_F(SimdKernelTest, scan) {
+  auto expect = simd::getKernels(simd::SimdLevel::SCALAR);
+  for (auto level : supportedLevels()) {
+    auto actual = simd::getKernels(level);
+    for (size_t begin = 0; begin < input_.size(); begin += 7) {
+      for (size_t len : {0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 200}) {
+        const char *p = input_.data() + begin;
+        const char *end = p + std::min(len, input_.size() - begin);
+        EXPECT_EQ(expect.skipWhiteSpace(p, end), actual.skipWhiteSpace(p, end))
+            << actual.name;
+        EXPECT_EQ(expect.scanString(p, end), actual.scanString(p, end))
+            << actual.name;
+        EXPECT_EQ(expect.skipDigits(p, end), actual.skipDigits(p, end))
+            << actual.name;
+      }
+    }
+  }
+}
+
+TEST_F(SimdKernelTest, classify) {
+  auto expect = simd::getKernels(simd::SimdLevel::SCALAR);
+  for (auto level : supportedLevels()) {
+    auto actual = simd::getKernels(level);
+    for (size_t begin = 0; begin + 64 <= input_.size(); begin += 13) {
+      auto m1 = expect.classify(input_.data() + begin);
+      auto m2 = actual.classify(input_.data() + begin);
+      EXPECT_EQ(m1.quote, m2.quote) << actual.name;
+      EXPECT_EQ(m1.backslash, m2.backslash) << actual.name;
+      EXPECT_EQ(m1.op, m2.op) << actual.name;
+      EXPECT_EQ(m1.space, m2.space) << actual.name;
+      EXPECT_EQ(m1.control, m2.control) << actual.name;
+    }
+  }
+}
+
+// 合法和不合法的UTF-8字符混杂 与scalar版本逐个位置比较
+TEST_F(SimdKernelTest, utf8) {
+  std::mt19937 rng(20240601);
+  const char *chars[] = {"a", " ", "\"", "\\", "\x01", "\x7f", "\xc2\x80",
+                         "\xdf\xbf", "\xe4\xb8\xad", "\xef\xbf\xbf",
+                         "\xf0\x90\x80\x80", "\xf4\x8f\xbf\xbf"};
+  // 过长编码、代理项、超出范围、孤立的后续字节、被截断的字符
+  const char *bad[] = {"\xc0\x80", "\xc1\xbf", "\xe0\x80\x80",
+                       "\xed\xa0\x80", "\xf0\x80\x80\x80",
+                       "\xf4\x90\x80\x80", "\xf5\x80\x80\x80", "\x80",
+                       "\xbf", "\xe4\xb8", "\xf0\x90\x80", "\xff"};
+  std::string input;
+  for (int i = 0; i < 20000; i++) {
+    if (rng() % 200 == 0) {
+      input += bad[rng() % (sizeof(bad) / sizeof(bad[0]))];
+    } else if (rng() % 3 == 0) {
+      input += chars[rng() % (sizeof(chars) / sizeof(chars[0]))];
+    } else {
+      // 较长的一段只含中文或只含ASCII的内容
+      input += rng() % 2 ? "\xe8\x9b\xa4" : "x";
+    }
+  }
+
+  auto expect = simd::getKernels(simd::SimdLevel::SCALAR);
+  for (auto level : supportedLevels()) {
+    auto actual = simd::getKernels(level);
+    for (size_t begin = 0; begin < input.size(); begin += 5) {
+      for (size_t len : {0, 1, 3, 16, 31, 32, 33, 64, 100, 1000}) {
+        const char *p = input.data() + begin;
+        const char *end = p + std::min(len, input.size() - begin);
+        ASSERT_EQ(expect.scanStringUtf8(p, end), actual.scanStringUtf8(p, end))
+            << actual.name << " " << begin << " " << len;
+      }
+    }
+  }
+
+  // 不含特殊字符的合法输入应扫描到末尾
+  std::string valid;
+  for (int i = 0; i < 100; i++) valid += "ab\xe4\xb8\xad\xf0\x9f\x98\x80";
+  for (auto level : supportedLevels()) {
+    auto actual = simd::getKernels(level);
+    const char *end = valid.data() + valid.size();
+    EXPECT_EQ(actual.scanStringUtf8(valid.data(), end), end) << actual.name;
+  }
+  for (auto s : bad) {
+    std::string text = std::string("ok") + s + "ok";
+    EXPECT_EQ(expect.scanStringUtf8(text.data(), text.data() + text.size()),
+              text.data() + 2)
+        << text;
+  }
+}
+
+TEST_F(SimdKernelTest, dispatch) {
+  EXPECT_EQ(simd::kernels().level, simd::detectSimdLevel());
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
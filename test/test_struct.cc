@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+
+#include <BufferedFileReadStream.hpp>
+#include <Document.hpp>
+#include <StringWriteStream.hpp>
+#include <StructMapping.hpp>
+#include <Writer.hpp>
+#include <cstdio>
+
+using namespace goa::json;
+
+namespace shop {
+
+struct Sku {
+  std::string title;
+  int64_t skuId = 0;
+};
+
+struct Item {
+  int id = 0;
+  double price = 0;
+  bool valid = false;
+  std::string title;
+  std::vector<std::string> tags;
+  std::optional<int> stock;
+  std::optional<Sku> sku;
+  std::vector<Sku> skus;
+};
+
+GOA_JSON_FIELDS(Sku, title, skuId)
+GOA_JSON_FIELDS(Item, id, price, valid, title, tags, stock, sku, skus)
+
+// key与成员名不同
+struct Order {
+  uint32_t orderId = 0;
+  float amount = 0;
+  std::vector<Item> items;
+};
+
+constexpr auto goaJsonFields(const Order *) {
+  return std::make_tuple(field("order_id", &Order::orderId),
+                         field("amount", &Order::amount),
+                         field("items", &Order::items));
+}
+
+}  // namespace shop
+
+TEST(json_struct, fields) {
+  std::string json =
+      "{\"id\": 42, \"price\": 9.9, \"valid\": true, \"title\": \"a\\nb\","
+      " \"tags\": [\"x\", \"y\"], \"stock\": 3,"
+      " \"sku\": {\"title\": \"red\", \"skuId\": 3103876140130},"
+      " \"skus\": [{\"title\": \"s1\"}, {\"skuId\": -1}]}";
+  shop::Item item;
+  ASSERT_EQ(parseStruct(json, item), ParseError::PARSE_OK);
+  EXPECT_EQ(item.id, 42);
+  EXPECT_EQ(item.price, 9.9);
+  EXPECT_TRUE(item.valid);
+  EXPECT_EQ(item.title, "a\nb");
+  EXPECT_EQ(item.tags, (std::vector<std::string>{"x", "y"}));
+  EXPECT_EQ(item.stock, 3);
+  ASSERT_TRUE(item.sku.has_value());
+  EXPECT_EQ(item.sku->title, "red");
+  EXPECT_EQ(item.sku->skuId, 3103876140130);
+  ASSERT_EQ(item.skus.size(), 2u);
+  EXPECT_EQ(item.skus[0].title, "s1");
+  EXPECT_EQ(item.skus[0].skuId, 0);
+  EXPECT_EQ(item.skus[1].skuId, -1);
+
+  // 整数可填入浮点数 null清空optional 数组覆盖原有元素 未出现的成员不变
+  json = "{\"price\": 10, \"stock\": null, \"sku\": null, \"tags\": []}";
+  ASSERT_EQ(parseStruct(json, item), ParseError::PARSE_OK);
+  EXPECT_EQ(item.price, 10.0);
+  EXPECT_FALSE(item.stock.has_value());
+  EXPECT_FALSE(item.sku.has_value());
+  EXPECT_TRUE(item.tags.empty());
+  EXPECT_EQ(item.id, 42);
+  EXPECT_EQ(item.skus.size(), 2u);
+}
+
+TEST(json_struct, rename) {
+  std::string json =
+      "{\"order_id\": 7, \"amount\": 1.5,"
+      " \"items\": [{\"id\": 1}, {\"id\": 2, \"tags\": [\"t\"]}]}";
+  shop::Order order;
+  ASSERT_EQ(parseStruct(json, order), ParseError::PARSE_OK);
+  EXPECT_EQ(order.orderId, 7u);
+  EXPECT_EQ(order.amount, 1.5f);
+  ASSERT_EQ(order.items.size(), 2u);
+  EXPECT_EQ(order.items[1].id, 2);
+  EXPECT_EQ(order.items[1].tags.size(), 1u);
+
+  // 根可以是vector等非结构体的类型
+  std::vector<std::optional<int>> values;
+  ASSERT_EQ(parseStruct("[1, null, 3]", values), ParseError::PARSE_OK);
+  EXPECT_EQ(values, (std::vector<std::optional<int>>{1, std::nullopt, 3}));
+}
+
+// 未知的key连同其值一起跳过 其中的语法错误照常报告
+TEST(json_struct, unknown) {
+  std::string json =
+      "{\"x\": {\"id\": 1, \"a\": [{\"id\": 2}, [3, {}]]}, \"id\": 5,"
+      " \"y\": [\"title\", null], \"z\": \"title\", \"sku\": {\"w\": 1}}";
+  shop::Item item;
+  ASSERT_EQ(parseStruct(json, item), ParseError::PARSE_OK);
+  EXPECT_EQ(item.id, 5);
+  EXPECT_TRUE(item.title.empty());
+  ASSERT_TRUE(item.sku.has_value());
+  EXPECT_TRUE(item.sku->title.empty());
+
+  EXPECT_EQ(parseStruct("{\"x\": [1, }", item), ParseError::PARSE_BAD_VALUE);
+
+  // Reader只检查这些值的语法 事件来自Document等其他来源时同样忽略
+  static_assert(hasSkipValue<StructHandler<shop::Item>>);
+  Document doc;
+  ASSERT_EQ(doc.parse(json), ParseError::PARSE_OK);
+  shop::Item replayed;
+  StructHandler<shop::Item> handler(replayed);
+  ASSERT_TRUE(doc.writeTo(handler));
+  EXPECT_EQ(replayed.id, 5);
+  EXPECT_TRUE(replayed.title.empty());
+  ASSERT_TRUE(replayed.sku.has_value());
+}
+
+TEST(json_struct, mismatch) {
+  shop::Item item;
+  for (std::string json :
+       {"{\"id\": 1.5}", "{\"id\": \"1\"}", "{\"id\": 2147483648}",
+        "{\"id\": null}", "{\"title\": 1}", "{\"valid\": 1}", "{\"tags\": {}}",
+        "{\"tags\": [1]}", "{\"sku\": []}", "{\"sku\": {\"title\": false}}",
+        "[]", "1"}) {
+    ParseResult result = parseStruct(json, item);
+    EXPECT_EQ(result, ParseError::PARSE_USER_STOPPED) << json;
+  }
+
+  shop::Order order;
+  EXPECT_EQ(parseStruct("{\"order_id\": -1}", order),
+            ParseError::PARSE_USER_STOPPED);
+  EXPECT_EQ(parseStruct("{\"order_id\": 4294967295}", order),
+            ParseError::PARSE_OK);
+  EXPECT_EQ(order.orderId, 4294967295u);
+}
+
+TEST(json_struct, stream) {
+  std::string json =
+      "{\"order_id\": 1, \"items\": [{\"title\": \"long enough title\"},"
+      " {\"id\": 123456789}]}";
+  FILE *input = tmpfile();
+  ASSERT_NE(input, nullptr);
+  fwrite(json.data(), 1, json.size(), input);
+  rewind(input);
+  BufferedFileReadStream is(input, 7);
+  shop::Order order;
+  ASSERT_EQ(parseStruct(is, order), ParseError::PARSE_OK);
+  fclose(input);
+  ASSERT_EQ(order.items.size(), 2u);
+  EXPECT_EQ(order.items[0].title, "long enough title");
+  EXPECT_EQ(order.items[1].id, 123456789);
+}
+
+TEST(json_struct, write) {
+  shop::Order order;
+  order.orderId = 4294967295u;
+  order.amount = 1.5f;
+  order.items.resize(2);
+  order.items[0].id = -3;
+  order.items[0].title = "a\"b";
+  order.items[0].tags = {"x", "y"};
+  order.items[0].stock = 0;
+  order.items[0].sku = shop::Sku{"red", 3103876140130};
+  order.items[1].valid = true;
+  order.items[1].skus.resize(1);
+
+  StringWriteStream os;
+  Writer writer(os);
+  ASSERT_TRUE(writeStruct(writer, order));
+  std::string json(os.getStringView());
+  EXPECT_EQ(json,
+            "{\"order_id\":4294967295,\"amount\":1.5,\"items\":["
+            "{\"id\":-3,\"price\":0.0,\"valid\":false,\"title\":\"a\\\"b\","
+            "\"tags\":[\"x\",\"y\"],\"stock\":0,"
+            "\"sku\":{\"title\":\"red\",\"skuId\":3103876140130},\"skus\":[]},"
+            "{\"id\":0,\"price\":0.0,\"valid\":true,\"title\":\"\","
+            "\"tags\":[],\"stock\":null,\"sku\":null,"
+            "\"skus\":[{\"title\":\"\",\"skuId\":0}]}]}");
+
+  // 写出的json解析回来与原值相同
+  shop::Order parsed;
+  ASSERT_EQ(parseStruct(json, parsed), ParseError::PARSE_OK);
+  StringWriteStream os2;
+  Writer writer2(os2);
+  ASSERT_TRUE(writeStruct(writer2, parsed));
+  EXPECT_EQ(os2.getStringView(), json);
+
+  // 其他handler同样适用
+  Document doc;
+  ASSERT_TRUE(writeStruct(doc, order));
+  EXPECT_EQ(doc["items"][0]["sku"]["skuId"].getInt64(), 3103876140130);
+  EXPECT_EQ(doc["order_id"].getInt64(), 4294967295);
+}
@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+
+#include <Document.hpp>
+#include <StringWriteStream.hpp>
+#include <StructuralReader.hpp>
+#include <Writer.hpp>
+#include <fstream>
+#include <sstream>
+
+using namespace goa::json;
+
+// 记录handler收到的全部事件 用于比较两种解析器
+class Recorder : noncopyable {
+ public:
+  bool Null() { return add("null"); }
+  bool Bool(bool b) { return add(b ? "true" : "false"); }
+  bool Int32(int32_t i32) { return add("i32:" + std::to_string(i32)); }
+  bool Int64(int64_t i64) { return add("i64:" + std::to_string(i64)); }
+  bool Double(double d) { return add("d:" + std::to_string(d)); }
+  bool String(std::string_view s) { return add("s:" + std::string(s)); }
+  bool StartObject() { return add("{"); }
+  bool Key(std::string_view s) { return add("k:" + std::string(s)); }
+  bool EndObject() { return add("}"); }
+  bool StartArray() { return add("["); }
+  bool EndArray() { return add("]"); }
+
+  std::string events;
+
+ private:
+  bool add(const std::string &e) {
+    events += e;
+    events += '|';
+    return true;
+  }
+};
+
+inline void TEST_SAME(const std::string &json) {
+  Recorder expect, actual;
+  StringReadStream is1(json), is2(json);
+  ParseResult result1 = Reader::parse(is1, expect);
+  ParseResult result2 = StructuralReader::parse(is2, actual);
+  EXPECT_EQ(result1, result2.err()) << json;
+  EXPECT_EQ(result1.getOffset(), result2.getOffset()) << json;
+  EXPECT_EQ(is1.getRemaining(), is2.getRemaining()) << json;
+  EXPECT_EQ(expect.events, actual.events) << json;
+}
+
+TEST(structural, value) {
+  TEST_SAME("null");
+  TEST_SAME("  true  ");
+  TEST_SAME("false");
+  TEST_SAME("-12.5e3");
+  TEST_SAME("12345678901");
+  TEST_SAME("1i64");
+  TEST_SAME("NaN");
+  TEST_SAME("-Infinity");
+  TEST_SAME("\"Hello\"");
+  TEST_SAME("\"Hello\\nWorld\\u00e9\\ud83d\\ude00\"");
+  TEST_SAME("[]");
+  TEST_SAME("{}");
+  TEST_SAME("[ null , false , true , 123 , \"abc\" , [ 1 , 2 , 3 ] ]");
+  TEST_SAME(
+      "{\"n\":null,\"f\":false,\"t\":true,\"i\":123,\"s\":\"abc\","
+      "\"a\":[1,2,3],\"o\":{\"1\":1,\"2\":2,\"3\":3}}");
+}
+
+TEST(structural, block_boundary) {
+  // 转义序列、字符串和标量跨越64字节块边界
+  for (size_t pad = 0; pad < 70; pad++) {
+    std::string space(pad, ' ');
+    TEST_SAME(space + "[\"a\\\\\\\"b\",\"\\\\\",12345,true]");
+    TEST_SAME("{\"" + std::string(pad, 'x') + "\\\"\":\"\\\\\\\\\"}");
+    TEST_SAME("[" + space + "\"" + space + "\\\\\"," + space + "-0.5]");
+  }
+}
+
+TEST(structural, error) {
+  TEST_SAME("");
+  TEST_SAME("   ");
+  TEST_SAME("nul");
+  TEST_SAME("?");
+  TEST_SAME("123abc");
+  TEST_SAME("null x");
+  TEST_SAME("[1,]");
+  TEST_SAME("[1 2]");
+  TEST_SAME("[1:2]");
+  TEST_SAME("[12ab]");
+  TEST_SAME("[");
+  TEST_SAME("{");
+  TEST_SAME("{1:1}");
+  TEST_SAME("{\"a\"}");
+  TEST_SAME("{\"a\":");
+  TEST_SAME("{\"a\":1 \"b\":2}");
+  TEST_SAME("\"abc");
+  TEST_SAME("[\"abc\\\"]");
+  TEST_SAME("\"\\x\"");
+  TEST_SAME("\"\x01\"");
+  TEST_SAME("\"\\ud800\"");
+  TEST_SAME("[1]]");
+  TEST_SAME("12ab");
+  TEST_SAME("[true false]");
+  TEST_SAME("{\"a\":1x, \"b\":2}");
+  TEST_SAME("[1, {\"a\": nulls}]");
+  TEST_SAME("{\"a\" 1}");
+  TEST_SAME(" [1 , 2 ]  x");
+  TEST_SAME("[\"a\",\n  \"b\"\n  \"c\"]");
+}
+
+// handler中止时 偏移量与Reader相同
+TEST(structural, user_stopped) {
+  struct Stopper : Recorder {
+    bool StartObject() { return ++count < stopAt && Recorder::StartObject(); }
+    bool EndArray() { return ++count < stopAt && Recorder::EndArray(); }
+    bool EndObject() { return ++count < stopAt && Recorder::EndObject(); }
+    bool Int32(int32_t i32) { return ++count < stopAt && Recorder::Int32(i32); }
+    int stopAt, count = 0;
+  };
+  std::string json = " [ {} , [ ] , 1 , { \"a\" : [ 2 ] } ] ";
+  for (int stopAt = 1; stopAt <= 8; stopAt++) {
+    Stopper expect, actual;
+    expect.stopAt = actual.stopAt = stopAt;
+    StringReadStream is1(json), is2(json);
+    ParseResult result1 = Reader::parse(is1, expect);
+    ParseResult result2 = StructuralReader::parse(is2, actual);
+    EXPECT_EQ(result1, ParseError::PARSE_USER_STOPPED) << stopAt;
+    EXPECT_EQ(result2, ParseError::PARSE_USER_STOPPED) << stopAt;
+    EXPECT_EQ(result1.getOffset(), result2.getOffset()) << stopAt;
+    EXPECT_EQ(expect.events, actual.events) << stopAt;
+  }
+}
+
+TEST(structural, depth) {
+  size_t max = ParseStack::kDefaultMaxDepth;
+  TEST_SAME(std::string(max, '[') + std::string(max, ']'));
+  TEST_SAME(std::string(max + 1, '[') + std::string(max + 1, ']'));
+  TEST_SAME(std::string(max - 1, '[') + "{\"a\":{}}" +
+            std::string(max - 1, ']'));
+
+  // 使用ParseStack中设置的限制
+  ParseStack stack(3);
+  StructuralIndex index;
+  Recorder handler;
+  for (std::string json : {"[[[]]]", "[[[1]]]", "[{\"a\":[{}]}]"}) {
+    StringReadStream is1(json), is2(json);
+    ParseResult expect = Reader::parse(is1, handler, stack);
+    ParseResult actual = StructuralReader::parse(is2, handler, index, stack);
+    EXPECT_EQ(actual, expect.err()) << json;
+    EXPECT_EQ(actual.getOffset(), expect.getOffset()) << json;
+  }
+  std::string deep = "[[[[]]]]";
+  StringReadStream is(deep);
+  ParseResult result = StructuralReader::parse(is, handler, index, stack);
+  EXPECT_EQ(result, ParseError::PARSE_DEPTH_EXCEEDED);
+  EXPECT_EQ(result.getOffset(), 3u);
+}
+
+// handler提供skipValue时 与Reader一样跳过这些值 只检查语法
+TEST(structural, skip_value) {
+  struct Skipper : Recorder {
+    bool Key(std::string_view s) {
+      skip = s == "skip";
+      return Recorder::Key(s);
+    }
+    bool skipValue() const { return skip; }
+    bool skip = false;
+  };
+  for (std::string json :
+       {"{\"skip\": {\"a\": [1, \"b\"]}, \"keep\": [2], \"skip\": 3}",
+        "{\"skip\": [1, }", "{\"skip\": 12ab}", "{\"skip\": [\"\\x\"]}"}) {
+    Skipper expect, actual;
+    StringReadStream is1(json), is2(json);
+    ParseResult result1 = Reader::parse(is1, expect);
+    ParseResult result2 = StructuralReader::parse(is2, actual);
+    EXPECT_EQ(result1, result2.err()) << json;
+    EXPECT_EQ(result1.getOffset(), result2.getOffset()) << json;
+    EXPECT_EQ(expect.events, actual.events) << json;
+  }
+}
+
+TEST(structural, taobao) {
+  std::ifstream in(GOA_JSON_DATA_DIR "/cart.json");
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  std::string json = buffer.str();
+  ASSERT_FALSE(json.empty());
+  TEST_SAME(json);
+
+  Document doc;
+  StringReadStream is(json);
+  EXPECT_EQ(StructuralReader::parse(is, doc), ParseError::PARSE_OK);
+  EXPECT_FALSE(is.hasNext());
+  StringWriteStream os;
+  Writer writer(os);
+  doc.writeTo(writer);
+  EXPECT_EQ(os.getStringView()[0], '{');
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
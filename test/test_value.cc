@@ -83,6 +83,40 @@ TEST(json_value, string_) {
   TEST_STRING("abcd");
   TEST_STRING("\n");
   TEST_STRING("\\n");
+  TEST_STRING(std::string_view("a\0b", 3));
+  TEST_STRING("thirteen char");
+  TEST_STRING("fourteen chars");
+}
+
+// 短字符串存放在Value内 长字符串的拷贝共享同一份数据
+TEST(json_value, short_string) {
+  EXPECT_EQ(sizeof(json::Value), 16u);
+  const size_t n = json::Value::kInlineCapacity;
+  std::string strings[] = {"", "tmall", std::string(n, 'x'),
+                           std::string(n + 1, 'y')};
+  for (const std::string &s : strings) {
+    bool inlined = s.size() <= n;
+    json::Value value(s);
+    json::Value copy(value);
+    EXPECT_EQ(copy.getStringView(), s);
+    EXPECT_EQ(copy.getStringView().data() == value.getStringView().data(),
+              !inlined);
+
+    json::Value moved(std::move(copy));
+    EXPECT_EQ(moved.getStringView(), s);
+    EXPECT_TRUE(copy.isNull());
+
+    json::Value assigned(1);
+    assigned = value;
+    EXPECT_EQ(assigned.getStringView(), s);
+    assigned = std::move(moved);
+    EXPECT_EQ(assigned.getStringView(), s);
+    value.setString("changed");
+    EXPECT_EQ(assigned.getStringView(), s);
+  }
+
+  json::Value empty(json::ValueType::TYPE_STRING);
+  EXPECT_EQ(empty.getStringView(), "");
 }
 
 int main(int argc, char **argv) {